@@ -0,0 +1,57 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <tygra/Package.hpp>
+
+/*
+Writes an asset package for SpiceMySponza.
+
+  PackageBuilder <output.pak> [--compress] [--align <bytes>] <file>...
+
+Each file is stored under the path it was given on the command line, so run
+the builder from the directory the demo loads its assets from, e.g.
+
+  PackageBuilder sponza.pak --compress sponza_vs.glsl sponza_fs.glsl diff0.png
+*/
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        std::cerr << "usage: PackageBuilder <output.pak> [--compress] "
+                     "[--align <bytes>] <file>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    tygra::PackageBuilder builder;
+    int file_count = 0;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--compress") {
+            builder.setCompression(true);
+        } else if (arg == "--align" && i + 1 < argc) {
+            builder.setAlignment(std::atoi(argv[++i]));
+        } else {
+            builder.addFile(arg, arg);
+            ++file_count;
+        }
+    }
+
+    if (!builder.write(argv[1])) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    tygra::Package package;
+    if (!package.open(argv[1])) {
+        std::cerr << "Failed to read back " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < package.entryCount(); ++i) {
+        const tygra::PackageView view = package.view(package.entryName(i));
+        std::cout << package.entryName(i) << " " << view.size() << " bytes"
+                  << (view.isMapped() ? "" : " (deflated)") << std::endl;
+    }
+    std::cout << file_count << " files written to " << argv[1] << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace SceneModel
+{
+
+// Allocator for std::vector that starts every array on an Alignment byte
+// boundary, so the arrays can be read with aligned SIMD loads.
+template<typename T, size_t Alignment = 16>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    pointer address(reference x) const { return &x; }
+
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (n == 0) {
+            return nullptr;
+        }
+        if (n > max_size()) {
+            throw std::bad_alloc();
+        }
+#ifdef _WIN32
+        void* p = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+        void* p = nullptr;
+        if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) {
+            p = nullptr;
+        }
+#endif
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<pointer>(p);
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new((void*)p) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U* p) { p->~U(); }
+};
+
+template<typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template<typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+} // end namespace SceneModel
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace SceneModel
+{
+
+// A path through space given in closed form, the same function of time on
+// the CPU as in a shader, so a renderer can send the parameters once and
+// work out positions from the time alone:
+//
+//   angle = frequency * time + phase
+//   position = centre + cosine_axis * cos(angle) + sine_axis * sin(angle)
+//
+// Two axes trace an ellipse, a single axis a wave along it.
+struct AnalyticMotion
+{
+    glm::vec3 centre;
+    glm::vec3 cosine_axis;
+    glm::vec3 sine_axis;
+    float frequency;
+    float phase;
+
+    // false for something moved any other way, then the rest is unused
+    bool animated;
+
+    AnalyticMotion();
+
+    // position with one component replaced by
+    // base + amplitude * cos(frequency * time + phase), like
+    // Animation::addWave
+    static AnalyticMotion wave(glm::vec3 position, int component,
+                               float base, float amplitude,
+                               float frequency, float phase);
+
+    static AnalyticMotion ellipse(glm::vec3 centre,
+                                  glm::vec3 cosine_axis,
+                                  glm::vec3 sine_axis,
+                                  float frequency, float phase);
+
+    glm::vec3 evaluate(float time) const;
+
+    bool operator==(const AnalyticMotion& other) const;
+
+    bool operator!=(const AnalyticMotion& other) const;
+};
+
+} // end namespace SceneModel
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "SceneModel_fwd.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace SceneModel
+{
+
+// Animates single float channels of instances and lights. Every track owns
+// one channel and is either a cosine wave or a looping set of linearly
+// interpolated keyframes. Tracks are stored as parallel arrays so evaluate()
+// runs the same arithmetic over long runs of floats, and large track counts
+// are split into batches evaluated on the shared JobSystem. Only the
+// registered channels are ever visited.
+class Animation
+{
+public:
+
+    enum TargetKind
+    {
+        kInstanceTarget,
+        kLightTarget
+    };
+
+    // component 0, 1 or 2 of the instance translation or light position,
+    // index is the position in the Context instance or light arrays
+    struct Target
+    {
+        TargetKind kind;
+        size_t index;
+        int component;
+    };
+
+    Animation();
+
+    ~Animation();
+
+    // value = base + amplitude * cos(frequency * time + phase)
+    size_t addWave(Target target,
+                   float base,
+                   float amplitude,
+                   float frequency,
+                   float phase);
+
+    // times must be increasing, the track loops after the last key
+    size_t addKeyframes(Target target,
+                        const std::vector<float>& times,
+                        const std::vector<float>& values);
+
+    void evaluate(float time);
+
+    size_t getTrackCount() const;
+
+    const Target* getTargetArray() const;
+
+    // results of the last evaluate, one per track
+    const float* getValueArray() const;
+
+    // the parameters addWave() was given, false for keyframe tracks
+    bool getWave(size_t track,
+                 float& base,
+                 float& amplitude,
+                 float& frequency,
+                 float& phase) const;
+
+    void clear();
+
+    // tracks per batch at least, so below twice this many evaluate() stays
+    // on the calling thread
+    static const size_t kParallelThreshold = 4096;
+
+private:
+
+    void evaluateRange(float time, size_t begin, size_t end);
+
+    std::vector<Target> targets_;
+    std::vector<float> values_;
+
+    // wave tracks, keyframe tracks have zero amplitude and frequency and
+    // take their value from the keys instead
+    std::vector<float> bases_;
+    std::vector<float> amplitudes_;
+    std::vector<float> frequencies_;
+    std::vector<float> phases_;
+
+    // first key and key count of each track, zero count for waves
+    std::vector<unsigned int> key_offsets_;
+    std::vector<unsigned int> key_counts_;
+    std::vector<float> key_times_;
+    std::vector<float> key_values_;
+
+};
+
+} // end namespace SceneModel
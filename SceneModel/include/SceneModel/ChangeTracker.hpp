@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace SceneModel
+{
+
+// A run of count changed elements starting at first.
+struct DirtyRange
+{
+    size_t first;
+    size_t count;
+};
+
+// Records which elements of an array changed in which version. Changes are
+// stamped with the next version and commit() makes it the current one only
+// if anything was touched, so versions only advance on real changes. A
+// reader remembers the version it last synced to and asks for the ranges
+// changed since then.
+class ChangeTracker
+{
+public:
+
+    ChangeTracker();
+
+    // zero until the first commit, so syncing from zero gets everything
+    unsigned int version() const;
+
+    // elements added count as changed, removing any counts as a change
+    void resize(size_t count);
+
+    void touch(size_t index);
+
+    void commit();
+
+    // replaces ranges with the changes after version, in index order
+    void changedSince(unsigned int version,
+                      std::vector<DirtyRange>& ranges) const;
+
+    // appends index to ranges, extending the last range when adjacent
+    static void addIndex(std::vector<DirtyRange>& ranges, size_t index);
+
+private:
+
+    std::vector<unsigned int> versions_;
+    unsigned int version_;
+    bool touched_;
+
+};
+
+} // end namespace SceneModel
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace SceneModel
+{
+
+// Seconds on a monotonic clock with sub-microsecond resolution, counted from
+// an arbitrary point. On Windows it reads the performance counter rather
+// than std::chrono, whose steady_clock only ticks with the system clock in
+// VS2013.
+double clockSeconds();
+
+}
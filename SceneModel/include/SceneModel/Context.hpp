@@ -1,10 +1,17 @@
 #pragma once
 
 #include "SceneModel_fwd.hpp"
+#include "AlignedAllocator.hpp"
+#include "Animation.hpp"
+#include "ChangeTracker.hpp"
+#include "HandleTable.hpp"
+#include "LightIndex.hpp"
+#include "SceneDescription.hpp"
+#include "TransformHierarchy.hpp"
 #include <glm/glm.hpp>
 #include <vector>
-#include <chrono>
 #include <memory>
+#include <utility>
 
 namespace SceneModel
 {
@@ -13,14 +20,63 @@ class Context
 {
 public:
 
+    // Bits of LightChange::fields.
+    enum LightField
+    {
+        kLightPosition = 1,
+        kLightIntensity = 2,
+        kLightRange = 4,
+        kLightMotion = 8
+    };
+
+    struct LightChange
+    {
+        size_t index; // into getAllLights()
+        unsigned int fields;
+    };
+
+    // Filled by getLightsChangedSince, lights that were added count as
+    // having every field changed.
+    struct LightChanges
+    {
+        unsigned int generation;
+        size_t light_count;
+        std::vector<LightChange> changed;
+        std::vector<LightId> removed;
+    };
+
+    enum EntityClass
+    {
+        kInstanceClass,
+        kMaterialClass,
+        kLightClass,
+        kCameraClass
+    };
+
     Context();
 
+    // builds the scene the description asks for instead of just the file
+    explicit Context(const SceneDescription& description);
+
     ~Context();
 
-    void update();
+    // give the same one to the GeometryBuilder
+    const SceneDescription& getDescription() const;
+
+    // advances by exactly dt seconds, for fixed timestep simulation
+    void step(float dt);
+
+    // turns the camera on the next step only, as if its rotational velocity
+    // were this much higher for that step, calls before the step add up;
+    // for mouse look, which arrives as movements rather than a held speed
+    void spinCamera(glm::vec2 velocity);
 
     bool toggleCameraAnimation();
 
+    // flies the camera on a fixed path driven purely by scene time, the
+    // path benchmarks use
+    void setCameraAnimation(bool animate);
+
     float getTimeInSeconds() const;
 
     glm::vec3 getUpDirection() const;
@@ -31,35 +87,186 @@ public:
 
     Camera& getCamera();
 
+    // Increases whenever anything of the class changes, for renderers to
+    // tell whether their copies are still current.
+    unsigned int getVersion(EntityClass entity_class) const;
+
+    // Indices changed after version, into getAllX() or the instance arrays
+    // (the camera is index 0), reusing the memory of ranges. Instances only
+    // change transform, entities removed from the end only show up in the
+    // count.
+    void getDirtyRangesSince(EntityClass entity_class,
+                             unsigned int version,
+                             std::vector<DirtyRange>& ranges) const;
+
     const std::vector<Light>& getAllLights() const;
 
+    // Ids of every kind are handles from a HandleTable, getAllX() holds the
+    // entities in the table's dense order. The ById lookups throw
+    // std::out_of_range for the id of an entity that was removed.
+    const Light& getLightById(LightId id) const;
+
+    const HandleTable& getLightHandles() const;
+
+    // every light by its index in getAllLights(), kept up to date as the
+    // lights change
+    const LightIndex& getLightIndex() const;
+
+    // Increases whenever any light is added, changed or removed, the same
+    // as getVersion(kLightClass).
+    unsigned int getLightGeneration() const;
+
+    // Pass the generation returned last time (zero the first time), the
+    // vectors in changes are reused so keep the same object between calls.
+    void getLightsChangedSince(unsigned int generation,
+                               LightChanges& changes) const;
+
     const std::vector<Material>& getAllMaterials() const;
 
     const Material& getMaterialById(MaterialId id) const;
 
+    const HandleTable& getMaterialHandles() const;
+
     const std::vector<Instance>& getAllInstances() const;
 
     const Instance& getInstanceById(InstanceId id) const;
 
     const std::vector<InstanceId> getInstancesByMeshId(MeshId id) const;
 
+    const HandleTable& getInstanceHandles() const;
+
+    // the meshes of the GeometryBuilder have the same handles
+    const HandleTable& getMeshHandles() const;
+
+    // The same instances as separate contiguous arrays, each holding
+    // getInstanceCount() elements in getAllInstances() order and starting
+    // on a 16 byte boundary. Prefer these when touching every instance.
+    size_t getInstanceCount() const;
+
+    const InstanceId* getInstanceIdArray() const;
+
+    const MeshId* getInstanceMeshIdArray() const;
+
+    const MaterialId* getInstanceMaterialIdArray() const;
+
+    const glm::mat4x3* getInstanceTransformArray() const;
+
+    // indices into the arrays above of the instances that aren't static,
+    // the only ones whose transforms ever change
+    const std::vector<size_t>& getDynamicInstanceIndices() const;
+
+    // How each instance moves when that has a closed form, in the same
+    // order as the arrays above, for renderers to evaluate on the GPU.
+    // Only root instances moved by a single wave get one, everything else
+    // isn't animated. Set while loading and by attachInstance().
+    const AnalyticMotion* getInstanceMotionArray() const;
+
+    // Attaches an instance to another so it follows the parent from then
+    // on, staying where it is now. Build the hierarchy before the Context
+    // goes to a Simulation, the children of moving instances stop being
+    // static. Throws std::invalid_argument for a cycle.
+    void attachInstance(InstanceId child, InstanceId parent);
+
+    // The light follows the instance at offset in the instance's space,
+    // until the light is removed.
+    void attachLight(LightId light, InstanceId parent, glm::vec3 offset);
+
+    // node i is instance i of the instance arrays, the world transforms
+    // are the instance transforms
+    const TransformHierarchy& getTransformHierarchy() const;
+
 private:
 
-    bool readFile(std::string filepath);
+    bool readFile(const SceneDescription& description);
+
+    void advanceTo(float time_seconds);
+
+    void updateLights();
+
+    void buildInstanceArrays();
+
+    void findDynamicInstances();
+
+    // closed forms of the entities a single animation wave moves
+    void findWaveMotions();
+
+    void setInstanceTransform(size_t index, const glm::mat4x3& xform);
+
+    bool setLightPosition(size_t index, glm::vec3 position,
+                          unsigned int generation);
+
+    bool setLightMotion(size_t index, const AnalyticMotion& motion,
+                        unsigned int generation);
+
+    struct ScatteredLight
+    {
+        glm::vec3 position;
+        float range;
+        glm::vec3 intensity;
+    };
+
+    struct LightAttachment
+    {
+        LightId light;
+        size_t instance;
+        glm::vec3 offset;
+    };
+
+    struct LightRecord
+    {
+        unsigned int position_generation;
+        unsigned int intensity_generation;
+        unsigned int range_generation;
+        unsigned int motion_generation;
+    };
+
+    SceneDescription description_;
 
-    std::chrono::system_clock::time_point start_time_;
 	float time_seconds_{ 0 };
 
     std::shared_ptr<FirstPersonMovement> camera_movement_;
     Camera camera_;
+    // spinCamera() total for the next step
+    glm::vec2 camera_spin_;
+    ChangeTracker camera_changes_;
 	bool animate_camera_{ false };
 
+    HandleTable light_handles_;
     std::vector<Light> lights_;
+    std::vector<LightRecord> light_records_;
+    LightIndex light_index_;
+    std::vector<std::pair<LightId, unsigned int>> removed_lights_;
+    std::vector<glm::vec3> orb_intensities_;
+    std::vector<ScatteredLight> scattered_lights_;
+    std::vector<LightAttachment> light_attachments_;
+    // the animation track moving each point and scattered light, if it's
+    // the only one
+    std::vector<size_t> light_wave_tracks_;
+    unsigned int light_generation_{ 0 };
 
+    HandleTable material_handles_;
     std::vector<Material> materials_;
+    ChangeTracker material_changes_;
+
+    HandleTable instance_handles_;
+    HandleTable mesh_handles_;
+
+    // the arrays are the instance storage, instances_ mirrors them for the
+    // per instance API
+    std::vector<InstanceId, AlignedAllocator<InstanceId>> instance_ids_;
+    std::vector<MeshId, AlignedAllocator<MeshId>> instance_mesh_ids_;
+    std::vector<MaterialId, AlignedAllocator<MaterialId>> instance_material_ids_;
+    std::vector<glm::mat4x3, AlignedAllocator<glm::mat4x3>> instance_transforms_;
+    ChangeTracker instance_changes_;
+    TransformHierarchy transforms_;
+    std::vector<AnalyticMotion> instance_motions_;
+
+    std::vector<size_t> dynamic_instances_;
 
     std::vector<Instance> instances_;
 
+    Animation animation_;
+
     std::vector<std::vector<InstanceId>> instances_by_mesh_;
 
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SceneModel_fwd.hpp"
+#include "HandleTable.hpp"
+#include "SceneDescription.hpp"
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
@@ -14,16 +16,23 @@ public:
 
     GeometryBuilder();
 
+    explicit GeometryBuilder(const SceneDescription& description);
+
     ~GeometryBuilder();
 
     const std::vector<Mesh>& getAllMeshes() const;
 
+    // throws std::out_of_range for ids of meshes that don't exist
     const Mesh& getMeshById(MeshId id) const;
 
 private:
 
-    bool readFile(std::string filepath);
+    bool readFile(const SceneDescription& description);
 
+    // meshes are handed out in file order, once per copy, from an empty
+    // table, so they get the same ids as the Context gives the meshes of
+    // its instances
+    HandleTable mesh_handles_;
     std::vector<Mesh> meshes_;
 
 };
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace SceneModel
+{
+
+// Slot map from generational handles to dense indices. Each handle holds a
+// slot number and that slot's generation, which changes when the entity in
+// the slot is removed, so a handle to a removed entity is detected instead
+// of silently finding whatever reused its slot. The entities themselves
+// live in ordinary arrays kept in dense index order by the owner, removal
+// moves the last entity into the hole so the arrays stay contiguous.
+//
+// Slot numbers are small and stable for an entity's lifetime, so other
+// systems can index their own tables by slot() instead of using maps.
+class HandleTable
+{
+public:
+
+    typedef unsigned int Handle;
+
+    // never returned by add()
+    static const Handle kNullHandle = 0;
+
+    static const unsigned int kSlotBits = 20;
+    static const unsigned int kMaxSlots = 1u << kSlotBits;
+
+    static size_t slot(Handle handle)
+    {
+        return handle & (kMaxSlots - 1);
+    }
+
+    static unsigned int generation(Handle handle)
+    {
+        return handle >> kSlotBits;
+    }
+
+    HandleTable();
+
+    // handle for a new entity at dense index size()
+    Handle add();
+
+    // The entity at the returned dense index must be replaced by the one at
+    // the last dense index, then the arrays shrunk by one.
+    size_t remove(Handle handle);
+
+    bool contains(Handle handle) const;
+
+    // throws std::out_of_range for handles not in the table
+    size_t denseIndex(Handle handle) const;
+
+    Handle handleAt(size_t dense_index) const;
+
+    size_t size() const;
+
+    // one more than the highest slot in use so far, the size tables indexed
+    // by slot need
+    size_t slotCount() const;
+
+    // removes everything, the handles given out so far all become stale,
+    // the slots are then reused in the same order as a fresh table's
+    void clear();
+
+private:
+
+    static const size_t kFreeSlot = ~(size_t)0;
+
+    void freeSlot(size_t slot_index);
+
+    std::vector<unsigned int> generations_;    // per slot
+    std::vector<size_t> dense_indices_;        // per slot
+    std::vector<Handle> handles_;              // per dense index
+    std::vector<size_t> free_slots_;
+
+};
+
+} // end namespace SceneModel
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SceneModel
+{
+
+// A pool of worker threads sharing small jobs by work stealing, for
+// everything that wants more than one core.
+//
+// Every worker has its own deque: it pushes and pops its own jobs at the
+// back, so nested fork/join stays on the cache that made the data, and when
+// it runs dry it steals the oldest job from the front of someone else's.
+// Threads outside the pool push onto a shared deque the workers steal from
+// too. Waiting on a group runs jobs instead of blocking, so a job may fork
+// and wait on its own group without tying up a worker.
+//
+// Jobs are counted against a Group and wait() returns once the group's
+// count is back to zero, rethrowing the first exception any of its jobs
+// threw. runAfter() chains a job onto a group so it only starts once that
+// group has finished.
+class JobSystem
+{
+public:
+
+    class Group
+    {
+    public:
+
+        Group();
+
+        ~Group();
+
+        // whether the group has nothing left to run, doesn't rethrow
+        bool isDone() const;
+
+    private:
+
+        friend class JobSystem;
+
+        Group(const Group&);
+        Group& operator=(const Group&);
+
+        std::atomic<int> pending_;
+        std::atomic_flag lock_;
+        std::vector<std::pair<Group*, std::function<void()>>> continuations_;
+        std::exception_ptr error_;
+    };
+
+    struct Stats
+    {
+        unsigned int workers;
+        unsigned long long jobs;
+        unsigned long long steals;
+        double idle_seconds;
+    };
+
+    // zero picks one fewer worker than the hardware threads, at least one
+    explicit JobSystem(unsigned int worker_count = 0);
+
+    // waits for the running jobs, the queued ones are dropped
+    ~JobSystem();
+
+    // the pool every subsystem shares, made on first use
+    static JobSystem& shared();
+
+    unsigned int getWorkerCount() const;
+
+    void run(Group& group, std::function<void()> job);
+
+    // job counts against group straight away but only becomes runnable once
+    // dependency has finished
+    void runAfter(Group& dependency, Group& group, std::function<void()> job);
+
+    // runs queued jobs until the group is done, rethrows its first error
+    void wait(Group& group);
+
+    // calls body(first, last) over [begin, end) in chunks of at least grain
+    // indices, returning once every chunk has run
+    template<typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Body& body);
+
+    // counters since construction or the last resetStats()
+    Stats getStats() const;
+
+    void resetStats();
+
+    // Runs jobs small jobs of work_per_job multiply-adds each, first one
+    // after another on this thread and then each as its own job, to
+    // weigh the scheduling overhead against the speedup. Resets the stats.
+    struct BenchmarkResult
+    {
+        size_t jobs;
+        double serial_seconds;
+        double parallel_seconds;
+        Stats stats;
+    };
+    BenchmarkResult benchmark(size_t jobs, size_t work_per_job);
+
+private:
+
+    JobSystem(const JobSystem&);
+    JobSystem& operator=(const JobSystem&);
+
+    struct Job
+    {
+        Group* group;
+        std::function<void()> work;
+    };
+
+    // one per worker, the last one is the shared queue for outside threads
+    struct Queue
+    {
+        Queue();
+
+        std::atomic_flag lock;
+        std::deque<Job> jobs;
+        std::atomic<unsigned long long> jobs_run;
+        std::atomic<unsigned long long> steals;
+        std::atomic<unsigned long long> idle_microseconds;
+    };
+
+    void workerLoop(size_t index);
+
+    // index of the calling thread's queue, the shared one for outsiders
+    size_t queueIndex() const;
+
+    void push(size_t queue, Job job);
+
+    // own queue from the back, then the others from the front, or only
+    // the back of its own queue if it holds a job of the given group
+    bool take(size_t queue, Job& job, Group* only);
+
+    // runs the job and then counts it off its group, queueing whatever was
+    // waiting on the group once it is done
+    void execute(size_t queue, Job& job);
+
+    unsigned int chunkCount(size_t count, size_t grain) const;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::vector<std::thread::id> worker_ids_;
+
+    // sleeping workers wait for queued_ to go above zero
+    std::atomic<int> queued_;
+    std::atomic<int> sleepers_;
+    std::atomic<bool> stop_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+};
+
+template<typename Body>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain,
+                            const Body& body)
+{
+    if (end <= begin) return;
+    const size_t count = end - begin;
+    const unsigned int chunks = chunkCount(count, grain);
+    if (chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    // this thread takes the first chunk itself
+    const size_t size = count / chunks;
+    const size_t extra = count % chunks;
+    Group group;
+    size_t first = begin + size + (extra > 0 ? 1 : 0);
+    for (unsigned int i = 1; i < chunks; ++i) {
+        const size_t last = first + size + (i < extra ? 1 : 0);
+        run(group, [&body, first, last]{ body(first, last); });
+        first = last;
+    }
+    std::exception_ptr error;
+    try {
+        body(begin, begin + size + (extra > 0 ? 1 : 0));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    wait(group);
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // end namespace SceneModel
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SceneModel_fwd.hpp"
+#include "AnalyticMotion.hpp"
 #include <glm/glm.hpp>
 
 namespace SceneModel
@@ -25,12 +26,18 @@ public:
     glm::vec3 getIntensity() const;
     void setIntensity(glm::vec3 i);
 
+    // how the light moves when that has a closed form, the position is
+    // kept at the motion's value for the current time
+    const AnalyticMotion& getMotion() const;
+    void setMotion(const AnalyticMotion& m);
+
 private:
     LightId id{ 0 };
     glm::vec3 position{ 0, 0, 0 };
     bool is_static{ false };
     glm::vec3 intensity{ 0.8f, 0.8f, 1 };
     float range{ 1 };
+    AnalyticMotion motion;
 
 };
 
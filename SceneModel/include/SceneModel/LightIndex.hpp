@@ -0,0 +1,133 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace SceneModel
+{
+
+// Finds the lights whose range spheres overlap a box, sphere or frustum
+// without visiting every light. Lights go into a stack of hashed grids
+// whose cell size doubles from level to level, each light into the cell
+// holding its position on the first level with cells at least as big as
+// its range. A query then only visits the cells near it on each level.
+// Moving a light within its cell costs nothing, moving it out costs one
+// removal and one insertion, so the index is kept up to date light by
+// light instead of being rebuilt.
+//
+// Lights are numbered by their index in the owner's light array. Results
+// come back in no particular order.
+class LightIndex
+{
+public:
+
+    // Convex volume given by its corners, the four of the near face then
+    // the four of the far face in the same order, and its planes facing
+    // inwards.
+    struct Frustum
+    {
+        glm::vec3 corners[8];
+        glm::vec4 planes[6];
+    };
+
+    // The part of a perspective view between two distances in front of
+    // the camera, e.g. one depth slice of a clustered view.
+    static Frustum frustumSlice(const glm::mat4& projection,
+                                const glm::mat4& view,
+                                float near_distance,
+                                float far_distance);
+
+    explicit LightIndex(float smallest_cell_size = 16.f);
+
+    // Adds the light or moves it, indices past size() grow the index.
+    void update(size_t index, glm::vec3 position, float range);
+
+    // Drops the lights from count onwards.
+    void resize(size_t count);
+
+    size_t size() const;
+
+    void clear();
+
+    // Replace lights with the lights overlapping the volume.
+    void queryBox(glm::vec3 box_min, glm::vec3 box_max,
+                  std::vector<size_t>& lights) const;
+
+    void querySphere(glm::vec3 centre, float radius,
+                     std::vector<size_t>& lights) const;
+
+    void queryFrustum(const Frustum& frustum,
+                      std::vector<size_t>& lights) const;
+
+    // Batches of queries, the lights for query i end up in
+    // lights[offsets[i]] to lights[offsets[i + 1]], so offsets gets
+    // count + 1 entries.
+    void queryBoxes(const glm::vec3* box_mins,
+                    const glm::vec3* box_maxs,
+                    size_t count,
+                    std::vector<size_t>& offsets,
+                    std::vector<size_t>& lights) const;
+
+    void querySpheres(const glm::vec3* centres,
+                      const float* radii,
+                      size_t count,
+                      std::vector<size_t>& offsets,
+                      std::vector<size_t>& lights) const;
+
+    void queryFrustums(const Frustum* frustums,
+                       size_t count,
+                       std::vector<size_t>& offsets,
+                       std::vector<size_t>& lights) const;
+
+    static const int kLevelCount = 8;
+
+private:
+
+    typedef unsigned long long CellKey;
+
+    struct Entry
+    {
+        glm::vec3 position;
+        float range;
+        int level;
+        CellKey cell;
+        bool active;
+    };
+
+    struct Level
+    {
+        float cell_size;
+        // largest range of any light ever put on this level
+        float max_range;
+        std::unordered_map<CellKey, std::vector<size_t>> cells;
+    };
+
+    int levelFor(float range) const;
+
+    CellKey cellKey(const Level& level, glm::vec3 position) const;
+
+    void remove(size_t index);
+
+    void appendBox(glm::vec3 box_min, glm::vec3 box_max,
+                   std::vector<size_t>& lights) const;
+
+    void appendSphere(glm::vec3 centre, float radius,
+                      std::vector<size_t>& lights) const;
+
+    void appendFrustum(const Frustum& frustum,
+                       std::vector<size_t>& lights) const;
+
+    // calls test(light) for every light in a cell near the box on any
+    // level, appending the ones it accepts to lights
+    template<typename Test>
+    void gather(glm::vec3 box_min, glm::vec3 box_max, Test test,
+                std::vector<size_t>& lights) const;
+
+    std::vector<Entry> entries_;
+    std::vector<Level> levels_;
+
+};
+
+} // end namespace SceneModel
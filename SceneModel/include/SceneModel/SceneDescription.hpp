@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+namespace SceneModel
+{
+
+// How to build a scene bigger than the one in the file, so everything can
+// be measured at scale on the same code paths. The defaults give exactly
+// the scene in the file. Context and GeometryBuilder must be given the same
+// description to agree on the meshes.
+struct SceneDescription
+{
+    std::string filepath{ "sponza.tcf" };
+
+    // copies of every instance on a columns x rows grid in the xz plane,
+    // the first tile where the file puts it, a spacing of zero fits the
+    // tiles to the bounds of the scene
+    int grid_columns{ 1 };
+    int grid_rows{ 1 };
+    float grid_spacing{ 0 };
+
+    // give every tile its own copy of the meshes instead of instancing the
+    // same ones
+    bool unique_meshes{ false };
+
+    // point lights scattered over the grid, each bobbing up and down, they
+    // come after the scene's two point lights and before its orbs
+    int scattered_lights{ 0 };
+
+    // materials past the scene's own four are tinted copies of them spread
+    // over the tiles, fewer than four keeps the four
+    int material_count{ 4 };
+
+    // for the scattered lights and the material tints
+    unsigned int seed{ 0 };
+
+    // a grid dimension under one counts as one
+    int tileCount() const
+    {
+        return (grid_columns > 1 ? grid_columns : 1)
+            * (grid_rows > 1 ? grid_rows : 1);
+    }
+};
+
+} // end namespace SceneModel
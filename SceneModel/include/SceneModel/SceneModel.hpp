@@ -1,10 +1,20 @@
 #pragma once
 
 #include "SceneModel_fwd.hpp"
+#include "AnalyticMotion.hpp"
+#include "Animation.hpp"
 #include "Camera.hpp"
+#include "ChangeTracker.hpp"
+#include "Clock.hpp"
 #include "Context.hpp"
 #include "GeometryBuilder.hpp"
+#include "HandleTable.hpp"
 #include "Instance.hpp"
 #include "Light.hpp"
+#include "LightIndex.hpp"
 #include "Material.hpp"
 #include "Mesh.hpp"
+#include "SceneDescription.hpp"
+#include "Simulation.hpp"
+#include "TransformHierarchy.hpp"
+#include "JobSystem.hpp"
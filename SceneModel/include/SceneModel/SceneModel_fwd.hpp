@@ -10,10 +10,14 @@ typedef unsigned int LightId;
 
 class FirstPersonMovement;
 
+struct AnalyticMotion;
+
 class Camera;
 
 class Light;
 
+class LightIndex;
+
 class Material;
 
 class Mesh;
@@ -22,6 +26,24 @@ class Instance;
 
 class GeometryBuilder;
 
+struct SceneDescription;
+
+class HandleTable;
+
+class ChangeTracker;
+
+class TransformHierarchy;
+
+class JobSystem;
+
+struct DirtyRange;
+
+class Animation;
+
+class Simulation;
+
+struct Snapshot;
+
 class Context;
 
 } // end namespace SceneModel
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "SceneModel_fwd.hpp"
+#include "Camera.hpp"
+#include "Context.hpp"
+#include "Light.hpp"
+#include "TripleBuffer.hpp"
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SceneModel
+{
+
+// Everything the renderer needs that changes while the scene runs, copied
+// out of the Context after one simulation step.
+struct Snapshot
+{
+    // simulation time and the time on the simulation's clock it was
+    // published at
+    float time{ 0 };
+    double published{ 0 };
+
+    Camera camera;
+    unsigned int camera_version{ 0 };
+
+    std::vector<Light> lights;
+
+    // light changes since the generation the reader had last acquired
+    Context::LightChanges light_changes;
+
+    // one per Context::getDynamicInstanceIndices() entry, in that order
+    std::vector<glm::mat4x3> dynamic_transforms;
+
+    // instances whose transforms changed since the version the reader had
+    // last acquired
+    unsigned int instance_version{ 0 };
+    std::vector<DirtyRange> dirty_instances;
+
+    // the sum of the versions of everything that can change, different
+    // whenever anything changed since the snapshot before
+    unsigned int scene_version{ 0 };
+};
+
+// Steps a Context at a fixed timestep and publishes a Snapshot after every
+// step through a lock-free triple buffer. Run it on its own thread with
+// start(), or call advance() once per frame to run the due steps on the
+// calling thread instead. Either way the steps are identical, so the
+// simulation is deterministic however fast the renderer goes.
+//
+// While it runs the Context belongs to the simulation, anything else that
+// needs to change it must post() a command. The static parts of the scene
+// (materials, meshes, static instance transforms) may still be read.
+class Simulation
+{
+public:
+
+    explicit Simulation(std::shared_ptr<Context> context,
+                        float timestep = 1.f / 60.f);
+
+    ~Simulation();
+
+    void start();
+
+    void stop();
+
+    bool isRunning() const;
+
+    // runs the steps that are due, only when not started
+    void advance();
+
+    float getTimestep() const;
+
+    // Swaps the wall clock for one that only moves in advanceClock(), so a
+    // benchmark or replay steps and interpolates exactly the same however
+    // long its frames take. Only with advance(), call before the first.
+    void setVirtualClock(bool virtual_clock);
+
+    bool hasVirtualClock() const;
+
+    void advanceClock(double seconds);
+
+    // seconds on the simulation's clock since it was created, the one the
+    // steps and Snapshot::published go by
+    double getClockSeconds() const;
+
+    // run on the simulation thread before the next step
+    void post(std::function<void(Context&)> command);
+
+    // steps taken so far, which while a step runs its commands is that
+    // step's index, counted from 0
+    unsigned int getStepCount() const;
+
+    // Called on whichever thread steps at the start of every step with its
+    // index, before the step takes the posted commands, so whatever the
+    // callback posts runs in that step. Lets a replay feed recorded input
+    // in on the step it was recorded on. Set before start().
+    void setStepCallback(std::function<void(unsigned int)> callback);
+
+    // Called on whichever thread steps, straight after every snapshot is
+    // published, e.g. so an on demand renderer can ask for a frame when
+    // Snapshot::scene_version moves. Set before start().
+    void setPublishCallback(std::function<void(const Snapshot&)> callback);
+
+    // Render thread only. Picks up the newest snapshot and returns it with
+    // the one the renderer had before, false until a step was published.
+    // Both stay valid until the next call.
+    bool latestSnapshots(const Snapshot*& previous, const Snapshot*& current);
+
+    // how far between previous and current to draw now, the renderer runs
+    // one timestep behind so it always has two snapshots to blend
+    float interpolationFactor(const Snapshot& previous,
+                              const Snapshot& current) const;
+
+    // every instance transform as it was before the first step, the static
+    // ones never change so renderers copy them from here
+    const std::vector<glm::mat4x3>& getInitialTransforms() const;
+
+    // steps behind schedule are dropped beyond this many at once
+    static const int kMaxCatchUpSteps = 8;
+
+private:
+
+    Simulation(const Simulation&);
+    Simulation& operator=(const Simulation&);
+
+    void threadLoop();
+
+    void stepAndPublish();
+
+    std::shared_ptr<Context> context_;
+    float timestep_;
+    double created_;
+    double next_step_;
+    bool virtual_clock_;
+    // advanced by one thread, read by whichever renders
+    std::atomic<double> virtual_seconds_;
+
+    std::vector<glm::mat4x3> initial_transforms_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<unsigned int> steps_;
+
+    std::mutex command_mutex_;
+    std::vector<std::function<void(Context&)>> commands_;
+    std::vector<std::function<void(Context&)>> running_commands_;
+
+    TripleBuffer<Snapshot> snapshots_;
+    std::function<void(unsigned int)> step_callback_;
+    std::function<void(const Snapshot&)> publish_callback_;
+    std::atomic<unsigned int> acquired_light_generation_;
+    std::atomic<unsigned int> acquired_instance_version_;
+    Snapshot previous_;
+    bool has_snapshot_;
+
+};
+
+} // end namespace SceneModel
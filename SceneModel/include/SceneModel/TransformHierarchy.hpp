@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace SceneModel
+{
+
+// Local and world transforms of a forest of nodes, for things attached to
+// other things. The nodes are laid out breadth-first in flat arrays: each
+// level of the trees follows the one above it and the children of a node
+// sit next to each other, so the parents' world transforms are final
+// before any child on the next level reads them.
+//
+// setLocal() only marks the node dirty. update() then recomputes the dirty
+// nodes and everything below them one level at a time, splitting big
+// levels over the shared JobSystem. Branches that weren't touched aren't
+// visited at all.
+//
+// Nodes are numbered in the order they were added and keep their number,
+// only their place in the arrays changes when the structure does.
+class TransformHierarchy
+{
+public:
+
+    typedef size_t Node;
+
+    static const Node kNoParent = ~(size_t)0;
+
+    TransformHierarchy();
+
+    // the world transform is valid straight away
+    Node addNode(Node parent, const glm::mat4x3& local);
+
+    // The node keeps its local transform, so it moves with its new parent
+    // from the next update(). Throws std::invalid_argument if the node
+    // would become its own ancestor.
+    void setParent(Node node, Node parent);
+
+    Node getParent(Node node) const;
+
+    void setLocal(Node node, const glm::mat4x3& local);
+
+    const glm::mat4x3& getLocal(Node node) const;
+
+    // as of the last update()
+    const glm::mat4x3& getWorld(Node node) const;
+
+    void update();
+
+    // the nodes the last update() recomputed, whether or not the result
+    // differs, in no particular order
+    const std::vector<Node>& getUpdatedNodes() const;
+
+    size_t size() const;
+
+    size_t getLevelCount() const;
+
+    void clear();
+
+    // dirty nodes per batch at least, so levels with fewer than twice this
+    // many stay on the calling thread
+    static const size_t kParallelThreshold = 4096;
+
+private:
+
+    // lays the arrays out breadth-first again after nodes were added or
+    // moved
+    void rebuild();
+
+    // world transforms of the nodes at the given positions, their parents
+    // must be up to date
+    void updatePositions(const size_t* positions, size_t count);
+
+    void computeWorlds(const size_t* positions, size_t count);
+
+    // by node
+    std::vector<Node> parents_;
+    std::vector<size_t> positions_;
+    std::vector<Node> dirty_nodes_;
+
+    // by position in the breadth-first order
+    std::vector<Node> nodes_;
+    std::vector<size_t> parent_positions_;
+    std::vector<size_t> first_children_;
+    std::vector<size_t> child_counts_;
+    std::vector<glm::mat4x3> locals_;
+    std::vector<glm::mat4x3> worlds_;
+    std::vector<unsigned char> dirty_;
+
+    // level i covers positions level_offsets_[i] to level_offsets_[i + 1]
+    std::vector<size_t> level_offsets_;
+    bool layout_dirty_;
+
+    // reused by update()
+    std::vector<std::vector<size_t>> pending_;
+    std::vector<size_t> previous_;
+    std::vector<size_t> current_;
+    std::vector<Node> updated_;
+
+};
+
+} // end namespace SceneModel
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+
+namespace SceneModel
+{
+
+// Hands values from one writer thread to one reader thread without locks.
+// The writer fills writeSlot() and publishes it, the reader takes the most
+// recently published value with acquire() and reads it from readSlot().
+// Neither side ever waits, values the reader didn't get to are dropped.
+template<typename T>
+class TripleBuffer
+{
+public:
+
+    TripleBuffer() : write_(0), read_(1), ready_(2) {}
+
+    // only the writer thread may touch this slot until it publishes it
+    T& writeSlot()
+    {
+        return slots_[write_];
+    }
+
+    void publish()
+    {
+        const unsigned int previous
+            = ready_.exchange(write_ | kFresh, std::memory_order_acq_rel);
+        write_ = previous & kIndexMask;
+    }
+
+    bool hasFresh() const
+    {
+        return (ready_.load(std::memory_order_relaxed) & kFresh) != 0;
+    }
+
+    // swaps in the newest published value, returns false if nothing new
+    // was published since the last acquire
+    bool acquire()
+    {
+        if ((ready_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        const unsigned int previous
+            = ready_.exchange(read_, std::memory_order_acq_rel);
+        read_ = previous & kIndexMask;
+        return true;
+    }
+
+    // only the reader thread may touch this slot until its next acquire
+    const T& readSlot() const
+    {
+        return slots_[read_];
+    }
+
+private:
+
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+
+    static const unsigned int kIndexMask = 3;
+    static const unsigned int kFresh = 4;
+
+    T slots_[3];
+    unsigned int write_;
+    unsigned int read_;
+    std::atomic<unsigned int> ready_;
+
+};
+
+} // end namespace SceneModel
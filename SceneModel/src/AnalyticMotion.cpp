@@ -0,0 +1,57 @@
+#include <SceneModel/AnalyticMotion.hpp>
+#include <cmath>
+
+using namespace SceneModel;
+
+AnalyticMotion::AnalyticMotion()
+    : centre(0), cosine_axis(0), sine_axis(0),
+      frequency(0), phase(0), animated(false)
+{
+}
+
+AnalyticMotion AnalyticMotion::wave(glm::vec3 position, int component,
+                                    float base, float amplitude,
+                                    float frequency, float phase)
+{
+    AnalyticMotion motion;
+    motion.centre = position;
+    motion.centre[component] = base;
+    motion.cosine_axis[component] = amplitude;
+    motion.frequency = frequency;
+    motion.phase = phase;
+    motion.animated = true;
+    return motion;
+}
+
+AnalyticMotion AnalyticMotion::ellipse(glm::vec3 centre,
+                                       glm::vec3 cosine_axis,
+                                       glm::vec3 sine_axis,
+                                       float frequency, float phase)
+{
+    AnalyticMotion motion;
+    motion.centre = centre;
+    motion.cosine_axis = cosine_axis;
+    motion.sine_axis = sine_axis;
+    motion.frequency = frequency;
+    motion.phase = phase;
+    motion.animated = true;
+    return motion;
+}
+
+glm::vec3 AnalyticMotion::evaluate(float time) const
+{
+    const float angle = frequency * time + phase;
+    return centre + cosine_axis * cosf(angle) + sine_axis * sinf(angle);
+}
+
+bool AnalyticMotion::operator==(const AnalyticMotion& other) const
+{
+    return animated == other.animated && centre == other.centre
+        && cosine_axis == other.cosine_axis && sine_axis == other.sine_axis
+        && frequency == other.frequency && phase == other.phase;
+}
+
+bool AnalyticMotion::operator!=(const AnalyticMotion& other) const
+{
+    return !(*this == other);
+}
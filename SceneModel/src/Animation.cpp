@@ -0,0 +1,144 @@
+#include <SceneModel/Animation.hpp>
+#include <SceneModel/JobSystem.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace SceneModel;
+
+Animation::Animation()
+{
+}
+
+Animation::~Animation()
+{
+}
+
+size_t Animation::addWave(Target target,
+                          float base,
+                          float amplitude,
+                          float frequency,
+                          float phase)
+{
+    targets_.push_back(target);
+    values_.push_back(base + amplitude * cosf(phase));
+    bases_.push_back(base);
+    amplitudes_.push_back(amplitude);
+    frequencies_.push_back(frequency);
+    phases_.push_back(phase);
+    key_offsets_.push_back(0);
+    key_counts_.push_back(0);
+    return targets_.size() - 1;
+}
+
+size_t Animation::addKeyframes(Target target,
+                               const std::vector<float>& times,
+                               const std::vector<float>& values)
+{
+    assert(!times.empty() && times.size() == values.size());
+
+    targets_.push_back(target);
+    values_.push_back(values[0]);
+    bases_.push_back(0.f);
+    amplitudes_.push_back(0.f);
+    frequencies_.push_back(0.f);
+    phases_.push_back(0.f);
+    key_offsets_.push_back((unsigned int)key_times_.size());
+    key_counts_.push_back((unsigned int)times.size());
+    key_times_.insert(key_times_.end(), times.begin(), times.end());
+    key_values_.insert(key_values_.end(), values.begin(), values.end());
+    return targets_.size() - 1;
+}
+
+void Animation::evaluate(float time)
+{
+    // each chunk of tracks on the shared job system
+    JobSystem::shared().parallelFor(0, targets_.size(), kParallelThreshold,
+        [this, time](size_t begin, size_t end) {
+            evaluateRange(time, begin, end);
+        });
+}
+
+void Animation::evaluateRange(float time, size_t begin, size_t end)
+{
+    // every track as a wave first, a straight loop over the arrays the
+    // compiler can vectorise
+    const float* bases = bases_.data();
+    const float* amplitudes = amplitudes_.data();
+    const float* frequencies = frequencies_.data();
+    const float* phases = phases_.data();
+    float* values = values_.data();
+    for (size_t i = begin; i < end; ++i) {
+        values[i] = bases[i]
+            + amplitudes[i] * cosf(frequencies[i] * time + phases[i]);
+    }
+
+    // then overwrite the keyframed ones
+    for (size_t i = begin; i < end; ++i) {
+        const unsigned int key_count = key_counts_[i];
+        if (key_count == 0) continue;
+
+        const float* times = &key_times_[key_offsets_[i]];
+        const float* keys = &key_values_[key_offsets_[i]];
+        const float duration = times[key_count - 1];
+        float t = duration > 0 ? fmodf(time, duration) : 0.f;
+        if (t < 0) t += duration;
+
+        const float* next = std::upper_bound(times, times + key_count, t);
+        if (next == times) {
+            values[i] = keys[0];
+        } else if (next == times + key_count) {
+            values[i] = keys[key_count - 1];
+        } else {
+            const size_t k = next - times;
+            const float span = times[k] - times[k - 1];
+            const float s = span > 0 ? (t - times[k - 1]) / span : 0.f;
+            values[i] = keys[k - 1] + s * (keys[k] - keys[k - 1]);
+        }
+    }
+}
+
+size_t Animation::getTrackCount() const
+{
+    return targets_.size();
+}
+
+const Animation::Target* Animation::getTargetArray() const
+{
+    return targets_.data();
+}
+
+const float* Animation::getValueArray() const
+{
+    return values_.data();
+}
+
+bool Animation::getWave(size_t track,
+                        float& base,
+                        float& amplitude,
+                        float& frequency,
+                        float& phase) const
+{
+    if (key_counts_[track] != 0) {
+        return false;
+    }
+    base = bases_[track];
+    amplitude = amplitudes_[track];
+    frequency = frequencies_[track];
+    phase = phases_[track];
+    return true;
+}
+
+void Animation::clear()
+{
+    targets_.clear();
+    values_.clear();
+    bases_.clear();
+    amplitudes_.clear();
+    frequencies_.clear();
+    phases_.clear();
+    key_offsets_.clear();
+    key_counts_.clear();
+    key_times_.clear();
+    key_values_.clear();
+}
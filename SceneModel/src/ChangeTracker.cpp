@@ -0,0 +1,58 @@
+#include <SceneModel/ChangeTracker.hpp>
+
+using namespace SceneModel;
+
+ChangeTracker::ChangeTracker() : version_(0), touched_(false)
+{
+}
+
+unsigned int ChangeTracker::version() const
+{
+    return version_;
+}
+
+void ChangeTracker::resize(size_t count)
+{
+    if (count == versions_.size()) return;
+    versions_.resize(count, version_ + 1);
+    touched_ = true;
+}
+
+void ChangeTracker::touch(size_t index)
+{
+    versions_[index] = version_ + 1;
+    touched_ = true;
+}
+
+void ChangeTracker::commit()
+{
+    if (touched_) {
+        ++version_;
+        touched_ = false;
+    }
+}
+
+void ChangeTracker::changedSince(unsigned int version,
+                                 std::vector<DirtyRange>& ranges) const
+{
+    ranges.clear();
+    if (version >= version_) return;
+    for (size_t i = 0; i < versions_.size(); ++i) {
+        if (versions_[i] > version) {
+            addIndex(ranges, i);
+        }
+    }
+}
+
+void ChangeTracker::addIndex(std::vector<DirtyRange>& ranges, size_t index)
+{
+    if (!ranges.empty()) {
+        DirtyRange& last = ranges.back();
+        if (last.first + last.count == index) {
+            ++last.count;
+            return;
+        }
+    }
+    const DirtyRange range = { index, 1 };
+    ranges.push_back(range);
+}
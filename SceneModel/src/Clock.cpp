@@ -0,0 +1,38 @@
+#include <SceneModel/Clock.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <chrono>
+#endif
+
+namespace
+{
+
+#ifdef _WIN32
+double counterPeriod()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return 1.0 / frequency.QuadPart;
+}
+
+// read once at startup, the frequency is fixed while the system runs
+const double kCounterPeriod = counterPeriod();
+#endif
+
+}
+
+double SceneModel::clockSeconds()
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * kCounterPeriod;
+#else
+    const std::chrono::duration<double> since_epoch
+        = std::chrono::steady_clock::now().time_since_epoch();
+    return since_epoch.count();
+#endif
+}
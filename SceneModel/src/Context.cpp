@@ -1,6 +1,8 @@
 #include <SceneModel/SceneModel.hpp>
 #include "FirstPersonMovement.hpp"
 #include <tcf/SimpleScene.hpp>
+#include <algorithm>
+#include <limits>
 #include <random>
 
 using namespace SceneModel;
@@ -21,12 +23,17 @@ using namespace SceneModel;
 *
 *****************************************************************************/
 
-Context::Context()
+Context::Context() : Context(SceneDescription())
 {
-    start_time_ = std::chrono::system_clock::now();
+}
 
-    if (!readFile("sponza.tcf")) {
-        throw std::runtime_error("Failed to read sponza.tcf data file");
+Context::Context(const SceneDescription& description)
+    : description_(description),
+      camera_spin_(0)
+{
+    if (!readFile(description)) {
+        throw std::runtime_error("Failed to read " + description.filepath
+                                 + " data file");
     }
 
     camera_movement_ = std::make_shared<FirstPersonMovement>();
@@ -36,47 +43,130 @@ Context::Context()
     camera_.setNearPlaneDistance(1);
     camera_.setFarPlaneDistance(1000);
 
-    update();
+    // start at exactly zero however long loading took, so fixed steps from
+    // here always give the same scene
+    advanceTo(0);
 }
 
 Context::~Context()
 {
 }
 
-bool Context::readFile(std::string filepath)
+bool Context::readFile(const SceneDescription& description)
 {
     tcf::Error error;
-    tcf::SimpleScene tcf_scene = tcf::simpleSceneFromFile(filepath, &error);
+    tcf::SimpleScene tcf_scene
+        = tcf::simpleSceneFromFile(description.filepath, &error);
     if (error != tcf::kNoError) {
         return false;
     }
 
     instances_.clear();
     instances_by_mesh_.clear();
+    materials_.clear();
+    instance_handles_.clear();
+    mesh_handles_.clear();
+    material_handles_.clear();
+
+	Material new_material(material_handles_.add());
+	new_material.setAmbientColour(glm::vec3(0.8f, 0.8f, 1));
+	new_material.setDiffuseColour(glm::vec3(0.8f, 0.8f, 0.8f));
+	new_material.setDiffuseTexture("diff0.png");
+    materials_.push_back(new_material);
+
+    // same ids as the GeometryBuilder gives the meshes, both add them in
+    // file order, once per copy, to an empty table
+    const int columns = std::max(description.grid_columns, 1);
+    const int rows = std::max(description.grid_rows, 1);
+    const int tile_count = columns * rows;
+    const int mesh_copies = description.unique_meshes ? tile_count : 1;
+    const size_t file_mesh_count = tcf_scene.meshArray.size();
+    for (int copy = 0; copy < mesh_copies; ++copy) {
+        for (size_t i = 0; i < file_mesh_count; ++i) {
+            mesh_handles_.add();
+        }
+    }
+    instances_by_mesh_.resize(mesh_handles_.size());
 
-    instances_by_mesh_.reserve(tcf_scene.meshArray.size());
+    // bounds of the scene in the file, near enough going by the instance
+    // translations alone
+    glm::vec3 scene_min(std::numeric_limits<float>::max());
+    glm::vec3 scene_max(-std::numeric_limits<float>::max());
     for (const auto& mesh : tcf_scene.meshArray) {
-        std::vector<InstanceId> instances;
-        instances.reserve(mesh.instanceArray.size());
-        instances_.reserve(instances_.size() + mesh.instanceArray.size());
+        if (mesh.vertexArray.empty()) continue;
+        const glm::vec3* vertices = (const glm::vec3*)&mesh.vertexArray.front();
+        glm::vec3 mesh_min = vertices[0];
+        glm::vec3 mesh_max = vertices[0];
+        for (size_t i = 1; i < mesh.vertexArray.size(); ++i) {
+            mesh_min = glm::min(mesh_min, vertices[i]);
+            mesh_max = glm::max(mesh_max, vertices[i]);
+        }
         for (const auto& model : mesh.instanceArray) {
-            Instance new_model(100 + instances_.size());
-            new_model.setMeshId(300 + instances_by_mesh_.size());
-            new_model.setMaterialId(200);
-            new_model.setTransformationMatrix(
-                glm::mat4x3(model.m00, model.m01, model.m02,
-                model.m10, model.m11, model.m12,
-                model.m20, model.m21, model.m22,
-                model.m30, model.m31, model.m32));
-            instances.push_back(new_model.getId());
-            instances_.push_back(new_model);
+            const glm::vec3 offset(model.m30, model.m31, model.m32);
+            scene_min = glm::min(scene_min, mesh_min + offset);
+            scene_max = glm::max(scene_max, mesh_max + offset);
         }
-        instances_by_mesh_.push_back(std::move(instances));
+    }
+    if (scene_max.x < scene_min.x) {
+        scene_min = scene_max = glm::vec3(0);
     }
 
+    // tiles are placed by the bounds of the scene unless told otherwise
+    const glm::vec3 tile_size = description.grid_spacing > 0
+        ? glm::vec3(description.grid_spacing)
+        : glm::max((scene_max - scene_min) * 1.1f, glm::vec3(1));
+    const glm::vec3 grid_min = scene_min;
+    const glm::vec3 grid_max = scene_min
+        + glm::vec3(columns * tile_size.x, 0, rows * tile_size.z);
+
+    size_t file_instance_count = 0;
+    for (const auto& mesh : tcf_scene.meshArray) {
+        file_instance_count += mesh.instanceArray.size();
+    }
+    instances_.reserve(tile_count * file_instance_count);
+
+    // every tile holds the instances of the file in the file's order
+    for (int tile = 0; tile < tile_count; ++tile) {
+        const int copy = description.unique_meshes ? tile : 0;
+        const glm::vec3 tile_offset(
+            (tile % columns) * tile_size.x,
+            0,
+            (tile / columns) * tile_size.z);
+        for (size_t m = 0; m < file_mesh_count; ++m) {
+            const size_t mesh_index = copy * file_mesh_count + m;
+            const MeshId mesh_id = mesh_handles_.handleAt(mesh_index);
+            for (const auto& model : tcf_scene.meshArray[m].instanceArray) {
+                Instance new_model(instance_handles_.add());
+                new_model.setMeshId(mesh_id);
+                new_model.setMaterialId(materials_[0].getId());
+                new_model.setTransformationMatrix(
+                    glm::mat4x3(model.m00, model.m01, model.m02,
+                    model.m10, model.m11, model.m12,
+                    model.m20, model.m21, model.m22,
+                    model.m30 + tile_offset.x,
+                    model.m31 + tile_offset.y,
+                    model.m32 + tile_offset.z));
+                instances_by_mesh_[mesh_index].push_back(new_model.getId());
+                instances_.push_back(new_model);
+            }
+        }
+    }
+
+    // only the instances of the first mesh in the file move
+    std::vector<MeshId> bouncing_meshes;
+    if (file_mesh_count > 0) {
+        for (int copy = 0; copy < mesh_copies; ++copy) {
+            bouncing_meshes.push_back(
+                mesh_handles_.handleAt(copy * file_mesh_count));
+        }
+    }
+    auto bounces = [&bouncing_meshes](MeshId mesh_id) {
+        return std::find(bouncing_meshes.begin(), bouncing_meshes.end(),
+                         mesh_id) != bouncing_meshes.end();
+    };
     for (auto& instance : instances_)
     {
-        instance.setStatic(instance.getMeshId() != 300);
+        instance.setStatic(!bounces(instance.getMeshId()));
     }
 
     int redShapes[] = { 35, 36, 37, 38, 39, 40, 41, 42, 69, 70, 71, 72, 73, 74,
@@ -110,13 +200,8 @@ bool Context::readFile(std::string filepath)
 		"spec2.png",
 		""
 	};
-	Material new_material(200);
-	new_material.setAmbientColour(glm::vec3(0.8f, 0.8f, 1));
-	new_material.setDiffuseColour(glm::vec3(0.8f, 0.8f, 0.8f));
-	new_material.setDiffuseTexture("diff0.png");
-    materials_.push_back(new_material);
     for (int j = 0; j<3; ++j) {
-        Material new_material(200 + j + 1);
+        Material new_material(material_handles_.add());
 		new_material.setAmbientColour(glm::vec3(0.8f, 0.8f, 1));
         new_material.setDiffuseColour(diffuse_colours[j]);
 		new_material.setDiffuseTexture(diffuse_textures[j]);
@@ -124,23 +209,190 @@ bool Context::readFile(std::string filepath)
         new_material.setShininess(shininess[j]);
 		new_material.setSpecularTexture(specular_textures[j]);
 		materials_.push_back(new_material);
-        for (int i = 0; i<numberOfShapes[j]; ++i) {
-            int index = shapes[j][i];
-            instances_[index].setMaterialId(new_material.getId());
+        for (int tile = 0; tile < tile_count; ++tile) {
+            const size_t first = tile * file_instance_count;
+            for (int i = 0; i<numberOfShapes[j]; ++i) {
+                size_t index = first + shapes[j][i];
+                if (index >= instances_.size()) continue;
+                instances_[index].setMaterialId(new_material.getId());
+            }
+        }
+    }
+
+    // the extra materials are tinted copies of the first four, an instance
+    // picks one of the copies of its own material so the tiles still look
+    // like the scene
+    const size_t file_material_count = materials_.size();
+    std::default_random_engine random(description.seed);
+    std::uniform_real_distribution<float> tint(0.5f, 1.f);
+    for (int j = (int)file_material_count; j < description.material_count; ++j) {
+        Material copy = materials_[j % file_material_count];
+        Material tinted(material_handles_.add());
+        tinted.setAmbientColour(copy.getAmbientColour());
+        tinted.setDiffuseColour(copy.getDiffuseColour()
+            * glm::vec3(tint(random), tint(random), tint(random)));
+        tinted.setDiffuseTexture(copy.getDiffuseTexture());
+        tinted.setSpecularColour(copy.getSpecularColour());
+        tinted.setShininess(copy.getShininess());
+        tinted.setSpecularTexture(copy.getSpecularTexture());
+        materials_.push_back(tinted);
+    }
+    if (materials_.size() > file_material_count) {
+        for (size_t i = 0; i < instances_.size(); ++i) {
+            const size_t base
+                = material_handles_.denseIndex(instances_[i].getMaterialId());
+            const size_t copies = (materials_.size() - base - 1)
+                / file_material_count + 1;
+            const size_t pick = base + (i % copies) * file_material_count;
+            instances_[i].setMaterialId(materials_[pick].getId());
         }
     }
 
+    material_changes_.resize(materials_.size());
+    material_changes_.commit();
+
+    buildInstanceArrays();
+
+    // the bouncing mesh instances bounce and the point lights swing back
+    // and forth
+    animation_.clear();
+    for (size_t i = 0; i < instance_mesh_ids_.size(); ++i) {
+        if (!bounces(instance_mesh_ids_[i])) continue;
+        const Animation::Target bounce = { Animation::kInstanceTarget, i, 1 };
+        animation_.addWave(bounce, 8.6f, 2.f, 1.f, 0.f);
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        const Animation::Target swing = { Animation::kLightTarget, i, 2 };
+        animation_.addWave(swing, -5.f, 15.f, 1.f, float(i));
+    }
+
+    // scattered lights bob at their own speed, they sit straight after the
+    // two point lights
+    scattered_lights_.clear();
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    for (int i = 0; i < description.scattered_lights; ++i) {
+        ScatteredLight light;
+        light.position = glm::vec3(
+            glm::mix(grid_min.x, grid_max.x, unit(random)),
+            glm::mix(10.f, 60.f, unit(random)),
+            glm::mix(grid_min.z, grid_max.z, unit(random)));
+        light.range = glm::mix(10.f, 40.f, unit(random));
+        light.intensity = glm::vec3(glm::mix(0.6f, 1.f, unit(random)),
+                                    glm::mix(0.6f, 1.f, unit(random)),
+                                    glm::mix(0.6f, 1.f, unit(random)));
+        scattered_lights_.push_back(light);
+
+        const Animation::Target bob = { Animation::kLightTarget, size_t(2 + i), 1 };
+        animation_.addWave(bob, light.position.y, 5.f,
+                           glm::mix(0.5f, 2.f, unit(random)),
+                           6.28f * unit(random));
+    }
+    findWaveMotions();
+
     return true;
 }
 
-void Context::update()
+void Context::buildInstanceArrays()
+{
+    const size_t count = instances_.size();
+    instance_ids_.resize(count);
+    instance_mesh_ids_.resize(count);
+    instance_material_ids_.resize(count);
+    instance_transforms_.resize(count);
+    transforms_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        instance_ids_[i] = instances_[i].getId();
+        instance_mesh_ids_[i] = instances_[i].getMeshId();
+        instance_material_ids_[i] = instances_[i].getMaterialId();
+        instance_transforms_[i] = instances_[i].getTransformationMatrix();
+        transforms_.addNode(TransformHierarchy::kNoParent,
+                            instance_transforms_[i]);
+    }
+    transforms_.update();
+    findDynamicInstances();
+    instance_changes_.resize(count);
+    instance_changes_.commit();
+}
+
+void Context::findDynamicInstances()
+{
+    // anything below a moving instance moves too
+    dynamic_instances_.clear();
+    for (size_t i = 0; i < instances_.size(); ++i) {
+        for (size_t node = i; node != TransformHierarchy::kNoParent;
+             node = transforms_.getParent(node)) {
+            if (!instances_[node].isStatic()) {
+                instances_[i].setStatic(false);
+                dynamic_instances_.push_back(i);
+                break;
+            }
+        }
+    }
+}
+
+void Context::findWaveMotions()
+{
+    const size_t no_track = std::numeric_limits<size_t>::max();
+    const size_t tracked_lights = 2 + scattered_lights_.size();
+    std::vector<size_t> instance_tracks(instances_.size(), no_track);
+    light_wave_tracks_.assign(tracked_lights, no_track);
+
+    // an entity with a second track moves some other way
+    const size_t conflict = no_track - 1;
+    const auto* targets = animation_.getTargetArray();
+    for (size_t i = 0; i < animation_.getTrackCount(); ++i) {
+        auto& tracks = targets[i].kind == Animation::kInstanceTarget
+            ? instance_tracks : light_wave_tracks_;
+        if (targets[i].index >= tracks.size()) continue;
+        size_t& track = tracks[targets[i].index];
+        track = track == no_track ? i : conflict;
+    }
+
+    float base, amplitude, frequency, phase;
+    instance_motions_.assign(instances_.size(), AnalyticMotion());
+    for (size_t i = 0; i < instances_.size(); ++i) {
+        const size_t track = instance_tracks[i];
+        if (track >= conflict
+            || transforms_.getParent(i) != TransformHierarchy::kNoParent
+            || !animation_.getWave(track, base, amplitude, frequency, phase)) {
+            continue;
+        }
+        instance_motions_[i] = AnalyticMotion::wave(
+            instance_transforms_[i][3], targets[track].component,
+            base, amplitude, frequency, phase);
+    }
+    for (auto& track : light_wave_tracks_) {
+        if (track == conflict) {
+            track = no_track;
+        }
+    }
+}
+
+void Context::setInstanceTransform(size_t index, const glm::mat4x3& xform)
+{
+    if (instance_transforms_[index] == xform) return;
+    instance_transforms_[index] = xform;
+    instances_[index].setTransformationMatrix(xform);
+    instance_changes_.touch(index);
+}
+
+void Context::step(float dt)
+{
+    advanceTo(time_seconds_ + dt);
+}
+
+void Context::spinCamera(glm::vec2 velocity)
+{
+    camera_spin_ += velocity;
+}
+
+void Context::advanceTo(float time_seconds)
 {
-    const auto clock_time = std::chrono::system_clock::now() - start_time_;
-    const auto clock_millisecs
-        = std::chrono::duration_cast<std::chrono::milliseconds>(clock_time);
     const float prev_time = time_seconds_;
-    time_seconds_ = 0.001f * clock_millisecs.count();
+    time_seconds_ = time_seconds;
     const float dt = time_seconds_ - prev_time;
+    const glm::vec3 prev_camera_position = camera_.getPosition();
+    const glm::vec3 prev_camera_direction = camera_.getDirection();
 
     if (animate_camera_) {
         const float t = -0.3f * time_seconds_;
@@ -159,7 +411,8 @@ void Context::update()
         camera_.setDirection(glm::normalize(look_at - cam_pos));
     } else {
         auto camera_translation_speed = getCamera().getLinearVelocity();
-        auto camera_rotation_speed = getCamera().getRotationalVelocity();
+        auto camera_rotation_speed = getCamera().getRotationalVelocity()
+            + camera_spin_;
         camera_movement_->moveForward(camera_translation_speed.z * dt);
         camera_movement_->moveRight(camera_translation_speed.x * dt);
         camera_movement_->spinHorizontal(camera_rotation_speed.x * dt);
@@ -167,58 +420,247 @@ void Context::update()
         camera_.setPosition(camera_movement_->position());
         camera_.setDirection(camera_movement_->direction());
     }
+    camera_spin_ = glm::vec2(0);
+
+    animation_.evaluate(time_seconds_);
+
+    // animation moves instances relative to their parents, the hierarchy
+    // then works out where everything below them went
+    const auto* targets = animation_.getTargetArray();
+    const float* values = animation_.getValueArray();
+    for (size_t i = 0; i < animation_.getTrackCount(); ++i) {
+        const auto& target = targets[i];
+        if (target.kind != Animation::kInstanceTarget) continue;
+
+        auto local = transforms_.getLocal(target.index);
+        if (local[3][target.component] == values[i]) continue;
+        local[3][target.component] = values[i];
+        transforms_.setLocal(target.index, local);
+    }
+    transforms_.update();
+    for (size_t node : transforms_.getUpdatedNodes()) {
+        setInstanceTransform(node, transforms_.getWorld(node));
+    }
+    instance_changes_.commit();
+
+    updateLights();
 
-    const float t = time_seconds_;
+    camera_changes_.resize(1);
+    if (camera_.getPosition() != prev_camera_position
+        || camera_.getDirection() != prev_camera_direction) {
+        camera_changes_.touch(0);
+    }
+    camera_changes_.commit();
+}
+
+void Context::updateLights()
+{
 	const bool off_phase = fmodf(time_seconds_, 5) > 3.f;
 
     const size_t num_of_point_lights = 2;
-	const size_t num_of_orb_lights = off_phase ? 10 : 20;
-	const size_t num_of_lights = num_of_point_lights + num_of_orb_lights;
-    if (lights_.capacity() < num_of_lights)
+	const size_t max_orb_lights = 20;
+	const size_t num_of_orb_lights = off_phase ? 10 : max_orb_lights;
+    const size_t num_of_scattered_lights = scattered_lights_.size();
+    const size_t first_orb_light = num_of_point_lights + num_of_scattered_lights;
+	const size_t num_of_lights = first_orb_light + num_of_orb_lights;
+
+    // orb colours never change so only roll them once
+    if (orb_intensities_.empty())
     {
-		lights_.reserve(num_of_lights);
+        auto r = std::default_random_engine(0);
+        auto rand = std::uniform_real_distribution<float>(0.6f, 1.f);
+        for (size_t i = 0; i < max_orb_lights; ++i) {
+            orb_intensities_.push_back(glm::vec3(rand(r), rand(r), rand(r)));
+        }
+        lights_.reserve(first_orb_light + max_orb_lights);
+        light_records_.reserve(first_orb_light + max_orb_lights);
     }
 
-    lights_.clear();
-    const LightId base_id = 407;
-	for (size_t i = 0; i < num_of_lights; ++i)
-	{
-		auto light = Light(LightId(base_id + i));
-		lights_.push_back(light);
-	}
+    // everything touched by this update is stamped with the next generation,
+    // which only becomes current if something really did change
+    const unsigned int generation = light_generation_ + 1;
+    bool changed = false;
+
+    while (lights_.size() > num_of_lights)
+    {
+        const LightId id = lights_.back().getId();
+        removed_lights_.push_back(std::make_pair(id, generation));
+        light_handles_.remove(id);
+        lights_.pop_back();
+        light_records_.pop_back();
+        changed = true;
+    }
+    while (lights_.size() < num_of_lights)
+    {
+        const size_t i = lights_.size();
+        auto light = Light(light_handles_.add());
+        if (i < num_of_point_lights) {
+            // both point lights swing along z around -5, see the waves above
+            light.setPosition(glm::vec3(i == 0 ? 75.f : -75.f, 110.f, -5.f));
+            light.setRange(250.f);
+        } else if (i < first_orb_light) {
+            const auto& scattered = scattered_lights_[i - num_of_point_lights];
+            light.setPosition(scattered.position);
+            light.setRange(scattered.range);
+            light.setIntensity(scattered.intensity);
+        } else {
+            light.setRange(20.f);
+            light.setIntensity(orb_intensities_[i - first_orb_light]);
+        }
+        // the lights moved by one wave track say so
+        float base, amplitude, frequency, phase;
+        if (i < light_wave_tracks_.size()
+            && light_wave_tracks_[i] != std::numeric_limits<size_t>::max()
+            && animation_.getWave(light_wave_tracks_[i],
+                                  base, amplitude, frequency, phase)) {
+            const int component
+                = animation_.getTargetArray()[light_wave_tracks_[i]].component;
+            light.setMotion(AnalyticMotion::wave(light.getPosition(), component,
+                                                 base, amplitude,
+                                                 frequency, phase));
+        }
+        lights_.push_back(light);
+        const LightRecord record
+            = { generation, generation, generation, generation };
+        light_records_.push_back(record);
+
+        // a light reusing a slot reports every field changed anyway, so it
+        // replaces the removal of the slot's previous light
+        for (size_t j = 0; j < removed_lights_.size(); ++j) {
+            if (HandleTable::slot(removed_lights_[j].first)
+                == HandleTable::slot(light.getId())) {
+                removed_lights_.erase(removed_lights_.begin() + j);
+                break;
+            }
+        }
+        changed = true;
+    }
 
-	lights_[0].setPosition(glm::vec3(75.f, 110.f, -5.f + 15.f * cosf(t)));
-    lights_[0].setRange(250.f);
+    const auto* targets = animation_.getTargetArray();
+    const float* values = animation_.getValueArray();
+    for (size_t i = 0; i < animation_.getTrackCount(); ++i) {
+        const auto& target = targets[i];
+        if (target.kind != Animation::kLightTarget
+            || target.index >= lights_.size()) continue;
 
-	lights_[1].setPosition(glm::vec3(-75.f, 110.f, -5.f + 15.f * cosf(1 + t)));
-	lights_[1].setRange(250.f);
+        auto position = lights_[target.index].getPosition();
+        position[target.component] = values[i];
+        changed |= setLightPosition(target.index, position, generation);
+    }
 
-	auto r = std::default_random_engine(0);
-	auto rand = std::uniform_real_distribution<float>(0.6f, 1.f);
-	for (size_t i = num_of_point_lights; i < num_of_lights; ++i) {
-		auto& light = lights_[i];
-		float A = time_seconds_ + i * 6.28f / num_of_orb_lights;
-        light.setPosition(glm::vec3(120.f * cosf(A), 10.f, 40.f * sinf(A)));
-		light.setRange(20.f);
-		light.setIntensity(glm::vec3(rand(r), rand(r), rand(r)));
+    // the orbs circle on an ellipse spaced evenly around it, so their
+    // phases change whenever the number of orbs does
+	for (size_t i = first_orb_light; i < num_of_lights; ++i) {
+        const float phase
+            = (i - num_of_scattered_lights) * 6.28f / num_of_orb_lights;
+        const auto orbit = AnalyticMotion::ellipse(glm::vec3(0.f, 10.f, 0.f),
+            glm::vec3(120.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 40.f), 1.f, phase);
+        changed |= setLightMotion(i, orbit, generation);
+        changed |= setLightPosition(i, orbit.evaluate(time_seconds_),
+                                    generation);
 	}
 
-    for (auto& instance : instances_)
-    {
-        if (instance.getMeshId() != 300) continue;
+    // attached lights go where their instance puts them, attachments of
+    // removed lights go with them
+    for (size_t i = 0; i < light_attachments_.size();) {
+        const auto& attachment = light_attachments_[i];
+        if (!light_handles_.contains(attachment.light)) {
+            light_attachments_[i] = light_attachments_.back();
+            light_attachments_.pop_back();
+            continue;
+        }
+        const glm::vec3 position = transforms_.getWorld(attachment.instance)
+            * glm::vec4(attachment.offset, 1.f);
+        const size_t index = light_handles_.denseIndex(attachment.light);
+        changed |= setLightMotion(index, AnalyticMotion(), generation);
+        changed |= setLightPosition(index, position, generation);
+        ++i;
+    }
 
-        auto xform = instance.getTransformationMatrix();
-        const float bounce_y = 4;
-        xform[3].y = 6.6f + bounce_y * (0.5f + 0.5f * cosf(t));
-        instance.setTransformationMatrix(xform);
+    if (changed) {
+        light_generation_ = generation;
+    }
+
+    // only the lights stamped with this generation moved or changed range
+    light_index_.resize(lights_.size());
+    for (size_t i = 0; i < lights_.size(); ++i) {
+        const auto& record = light_records_[i];
+        if (record.position_generation == generation
+            || record.range_generation == generation) {
+            light_index_.update(i, lights_[i].getPosition(),
+                                lights_[i].getRange());
+        }
     }
 }
 
+bool Context::setLightPosition(size_t index, glm::vec3 position,
+                               unsigned int generation)
+{
+    auto& light = lights_[index];
+    if (light.getPosition() == position) {
+        return false;
+    }
+    light.setPosition(position);
+    light_records_[index].position_generation = generation;
+    return true;
+}
+
+void Context::attachInstance(InstanceId child, InstanceId parent)
+{
+    const size_t child_index = instance_handles_.denseIndex(child);
+    const size_t parent_index = instance_handles_.denseIndex(parent);
+    const glm::mat4 parent_world(transforms_.getWorld(parent_index));
+    const glm::mat4 child_world(transforms_.getWorld(child_index));
+
+    transforms_.setParent(child_index, parent_index);
+    // its motion is relative to the parent now, so not closed form any more
+    instance_motions_[child_index] = AnalyticMotion();
+    transforms_.setLocal(child_index,
+        glm::mat4x3(glm::inverse(parent_world) * child_world));
+    transforms_.update();
+    for (size_t node : transforms_.getUpdatedNodes()) {
+        setInstanceTransform(node, transforms_.getWorld(node));
+    }
+    instance_changes_.commit();
+    findDynamicInstances();
+}
+
+void Context::attachLight(LightId light, InstanceId parent, glm::vec3 offset)
+{
+    // throws for a light that's gone like the instance lookup does
+    light_handles_.denseIndex(light);
+    const LightAttachment attachment
+        = { light, instance_handles_.denseIndex(parent), offset };
+    light_attachments_.push_back(attachment);
+}
+
+const TransformHierarchy& Context::getTransformHierarchy() const
+{
+    return transforms_;
+}
+
+bool Context::setLightMotion(size_t index, const AnalyticMotion& motion,
+                             unsigned int generation)
+{
+    auto& light = lights_[index];
+    if (light.getMotion() == motion) {
+        return false;
+    }
+    light.setMotion(motion);
+    light_records_[index].motion_generation = generation;
+    return true;
+}
+
 bool Context::toggleCameraAnimation()
 {
     return animate_camera_ = !animate_camera_;
 }
 
+void Context::setCameraAnimation(bool animate)
+{
+    animate_camera_ = animate;
+}
+
 float Context::getTimeInSeconds() const
 {
     return time_seconds_;
@@ -249,6 +691,111 @@ const std::vector<Light>& Context::getAllLights() const
     return lights_;
 }
 
+const Light& Context::getLightById(LightId id) const
+{
+    return lights_[light_handles_.denseIndex(id)];
+}
+
+const SceneDescription& Context::getDescription() const
+{
+    return description_;
+}
+
+const HandleTable& Context::getLightHandles() const
+{
+    return light_handles_;
+}
+
+const LightIndex& Context::getLightIndex() const
+{
+    return light_index_;
+}
+
+unsigned int Context::getVersion(EntityClass entity_class) const
+{
+    switch (entity_class) {
+    case kInstanceClass:
+        return instance_changes_.version();
+    case kMaterialClass:
+        return material_changes_.version();
+    case kLightClass:
+        return light_generation_;
+    case kCameraClass:
+        return camera_changes_.version();
+    }
+    return 0;
+}
+
+void Context::getDirtyRangesSince(EntityClass entity_class,
+                                  unsigned int version,
+                                  std::vector<DirtyRange>& ranges) const
+{
+    switch (entity_class) {
+    case kInstanceClass:
+        instance_changes_.changedSince(version, ranges);
+        break;
+    case kMaterialClass:
+        material_changes_.changedSince(version, ranges);
+        break;
+    case kLightClass:
+        // lights keep a generation per field, any of them will do here
+        ranges.clear();
+        for (size_t i = 0; i < light_records_.size(); ++i) {
+            const auto& record = light_records_[i];
+            if (record.position_generation > version
+                || record.intensity_generation > version
+                || record.range_generation > version
+                || record.motion_generation > version) {
+                ChangeTracker::addIndex(ranges, i);
+            }
+        }
+        break;
+    case kCameraClass:
+        camera_changes_.changedSince(version, ranges);
+        break;
+    }
+}
+
+unsigned int Context::getLightGeneration() const
+{
+    return light_generation_;
+}
+
+void Context::getLightsChangedSince(unsigned int generation,
+                                    LightChanges& changes) const
+{
+    changes.generation = light_generation_;
+    changes.light_count = lights_.size();
+    changes.changed.clear();
+    changes.removed.clear();
+
+    for (size_t i = 0; i < light_records_.size(); ++i) {
+        const auto& record = light_records_[i];
+        LightChange change = { i, 0 };
+        if (record.position_generation > generation) {
+            change.fields |= kLightPosition;
+        }
+        if (record.intensity_generation > generation) {
+            change.fields |= kLightIntensity;
+        }
+        if (record.range_generation > generation) {
+            change.fields |= kLightRange;
+        }
+        if (record.motion_generation > generation) {
+            change.fields |= kLightMotion;
+        }
+        if (change.fields != 0) {
+            changes.changed.push_back(change);
+        }
+    }
+
+    for (const auto& removed : removed_lights_) {
+        if (removed.second > generation) {
+            changes.removed.push_back(removed.first);
+        }
+    }
+}
+
 const std::vector<Material>& Context::getAllMaterials() const
 {
     return materials_;
@@ -256,7 +803,12 @@ const std::vector<Material>& Context::getAllMaterials() const
 
 const Material& Context::getMaterialById(MaterialId id) const
 {
-    return materials_[id - 200];
+    return materials_[material_handles_.denseIndex(id)];
+}
+
+const HandleTable& Context::getMaterialHandles() const
+{
+    return material_handles_;
 }
 
 const std::vector<Instance>& Context::getAllInstances() const
@@ -266,10 +818,55 @@ const std::vector<Instance>& Context::getAllInstances() const
 
 const Instance& Context::getInstanceById(InstanceId id) const
 {
-    return instances_[id - 100];
+    return instances_[instance_handles_.denseIndex(id)];
 }
 
 const std::vector<InstanceId> Context::getInstancesByMeshId(MeshId id) const
 {
-    return instances_by_mesh_[id - 300];
+    return instances_by_mesh_[mesh_handles_.denseIndex(id)];
+}
+
+const HandleTable& Context::getInstanceHandles() const
+{
+    return instance_handles_;
+}
+
+const HandleTable& Context::getMeshHandles() const
+{
+    return mesh_handles_;
+}
+
+size_t Context::getInstanceCount() const
+{
+    return instance_ids_.size();
+}
+
+const AnalyticMotion* Context::getInstanceMotionArray() const
+{
+    return instance_motions_.data();
+}
+
+const std::vector<size_t>& Context::getDynamicInstanceIndices() const
+{
+    return dynamic_instances_;
+}
+
+const InstanceId* Context::getInstanceIdArray() const
+{
+    return instance_ids_.data();
+}
+
+const MeshId* Context::getInstanceMeshIdArray() const
+{
+    return instance_mesh_ids_.data();
+}
+
+const MaterialId* Context::getInstanceMaterialIdArray() const
+{
+    return instance_material_ids_.data();
+}
+
+const glm::mat4x3* Context::getInstanceTransformArray() const
+{
+    return instance_transforms_.data();
 }
@@ -16,10 +16,15 @@ using namespace SceneModel;
 *
 *****************************************************************************/
 
-GeometryBuilder::GeometryBuilder()
+GeometryBuilder::GeometryBuilder() : GeometryBuilder(SceneDescription())
 {
-    if (!readFile("sponza.tcf")) {
-        throw std::runtime_error("Failed to read sponza.tcf data file");
+}
+
+GeometryBuilder::GeometryBuilder(const SceneDescription& description)
+{
+    if (!readFile(description)) {
+        throw std::runtime_error("Failed to read " + description.filepath
+                                 + " data file");
     }
 }
 
@@ -35,42 +40,48 @@ const std::vector<Mesh>& GeometryBuilder::getAllMeshes() const
 
 const Mesh& GeometryBuilder::getMeshById(MeshId id) const
 {
-    return meshes_[id - 300];
+    return meshes_[mesh_handles_.denseIndex(id)];
 }
 
-bool GeometryBuilder::readFile(std::string filepath)
+bool GeometryBuilder::readFile(const SceneDescription& description)
 {
     tcf::Error error;
-    tcf::SimpleScene tcf_scene = tcf::simpleSceneFromFile(filepath, &error);
+    tcf::SimpleScene tcf_scene
+        = tcf::simpleSceneFromFile(description.filepath, &error);
     if (error != tcf::kNoError) {
         return false;
     }
 
     meshes_.clear();
+    mesh_handles_.clear();
 
-    meshes_.reserve(tcf_scene.meshArray.size());
-    for (const auto& mesh : tcf_scene.meshArray) {
-        Mesh new_mesh(300 + meshes_.size());
-        new_mesh.assignElementArray(std::vector<unsigned int>(
-            (unsigned int*)&mesh.indexArray.front(),
-            (unsigned int*)&mesh.indexArray.back() + 1));
-        new_mesh.assignNormalArray(std::vector<glm::vec3>(
-            (glm::vec3*)&mesh.normalArray.front(),
-            (glm::vec3*)&mesh.normalArray.back() + 1));
-        new_mesh.assignPositionArray(std::vector<glm::vec3>(
-            (glm::vec3*)&mesh.vertexArray.front(),
-            (glm::vec3*)&mesh.vertexArray.back() + 1));
-        if (!mesh.tangentArray.empty()) {
-            new_mesh.assignTangentArray(std::vector<glm::vec3>(
-                (glm::vec3*)&mesh.tangentArray.front(),
-                (glm::vec3*)&mesh.tangentArray.back() + 1));
-        }
-        if (!mesh.texcoordArray.empty()) {
-            new_mesh.assignTextureCoordinateArray(std::vector<glm::vec2>(
-                (glm::vec2*)&mesh.texcoordArray.front(),
-                (glm::vec2*)&mesh.texcoordArray.back() + 1));
+    const int copies
+        = description.unique_meshes ? description.tileCount() : 1;
+    meshes_.reserve(copies * tcf_scene.meshArray.size());
+    for (int copy = 0; copy < copies; ++copy) {
+        for (const auto& mesh : tcf_scene.meshArray) {
+            Mesh new_mesh(mesh_handles_.add());
+            new_mesh.assignElementArray(std::vector<unsigned int>(
+                (unsigned int*)&mesh.indexArray.front(),
+                (unsigned int*)&mesh.indexArray.back() + 1));
+            new_mesh.assignNormalArray(std::vector<glm::vec3>(
+                (glm::vec3*)&mesh.normalArray.front(),
+                (glm::vec3*)&mesh.normalArray.back() + 1));
+            new_mesh.assignPositionArray(std::vector<glm::vec3>(
+                (glm::vec3*)&mesh.vertexArray.front(),
+                (glm::vec3*)&mesh.vertexArray.back() + 1));
+            if (!mesh.tangentArray.empty()) {
+                new_mesh.assignTangentArray(std::vector<glm::vec3>(
+                    (glm::vec3*)&mesh.tangentArray.front(),
+                    (glm::vec3*)&mesh.tangentArray.back() + 1));
+            }
+            if (!mesh.texcoordArray.empty()) {
+                new_mesh.assignTextureCoordinateArray(std::vector<glm::vec2>(
+                    (glm::vec2*)&mesh.texcoordArray.front(),
+                    (glm::vec2*)&mesh.texcoordArray.back() + 1));
+            }
+            meshes_.push_back(new_mesh);
         }
-        meshes_.push_back(new_mesh);
     }
 
     return true;
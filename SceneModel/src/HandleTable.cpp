@@ -0,0 +1,103 @@
+#include <SceneModel/HandleTable.hpp>
+#include <stdexcept>
+
+using namespace SceneModel;
+
+HandleTable::HandleTable()
+{
+}
+
+HandleTable::Handle HandleTable::add()
+{
+    size_t slot_index;
+    if (!free_slots_.empty()) {
+        slot_index = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        if (generations_.size() == kMaxSlots) {
+            throw std::length_error("HandleTable is full");
+        }
+        slot_index = generations_.size();
+        generations_.push_back(1);
+        dense_indices_.push_back(0);
+    }
+
+    const Handle handle
+        = (generations_[slot_index] << kSlotBits) | (Handle)slot_index;
+    dense_indices_[slot_index] = handles_.size();
+    handles_.push_back(handle);
+    return handle;
+}
+
+size_t HandleTable::remove(Handle handle)
+{
+    const size_t hole = denseIndex(handle);
+    const size_t slot_index = slot(handle);
+
+    // the last entity moves into the hole
+    const Handle moved = handles_.back();
+    handles_[hole] = moved;
+    dense_indices_[slot(moved)] = hole;
+    handles_.pop_back();
+
+    freeSlot(slot_index);
+    return hole;
+}
+
+void HandleTable::freeSlot(size_t slot_index)
+{
+    // generation zero is skipped so no handle is ever kNullHandle
+    const unsigned int max_generation = (1u << (32 - kSlotBits)) - 1;
+    generations_[slot_index] = generations_[slot_index] == max_generation
+        ? 1 : generations_[slot_index] + 1;
+    dense_indices_[slot_index] = kFreeSlot;
+    free_slots_.push_back(slot_index);
+}
+
+bool HandleTable::contains(Handle handle) const
+{
+    const size_t slot_index = slot(handle);
+    return slot_index < generations_.size()
+        && generations_[slot_index] == generation(handle)
+        && dense_indices_[slot_index] != kFreeSlot;
+}
+
+size_t HandleTable::denseIndex(Handle handle) const
+{
+    if (!contains(handle)) {
+        throw std::out_of_range("Stale or invalid handle");
+    }
+    return dense_indices_[slot(handle)];
+}
+
+HandleTable::Handle HandleTable::handleAt(size_t dense_index) const
+{
+    return handles_[dense_index];
+}
+
+size_t HandleTable::size() const
+{
+    return handles_.size();
+}
+
+size_t HandleTable::slotCount() const
+{
+    return generations_.size();
+}
+
+void HandleTable::clear()
+{
+    // slots keep their generations so handles from before stay stale
+    for (Handle handle : handles_) {
+        freeSlot(slot(handle));
+    }
+    handles_.clear();
+
+    // every slot is free now, refill the list so add() hands them out from
+    // slot 0 up again like a fresh table, otherwise tables cleared at
+    // different times would no longer agree on ids
+    free_slots_.clear();
+    for (size_t i = generations_.size(); i > 0; --i) {
+        free_slots_.push_back(i - 1);
+    }
+}
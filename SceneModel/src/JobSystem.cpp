@@ -0,0 +1,354 @@
+#include <SceneModel/JobSystem.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+using namespace SceneModel;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+// the queues and groups are only ever held for a push or a pop
+class SpinLock
+{
+public:
+    explicit SpinLock(std::atomic_flag& flag) : flag_(flag)
+    {
+        while (flag_.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    ~SpinLock()
+    {
+        flag_.clear(std::memory_order_release);
+    }
+
+private:
+    SpinLock(const SpinLock&);
+    SpinLock& operator=(const SpinLock&);
+
+    std::atomic_flag& flag_;
+};
+
+// rounds a worker tries to steal before it goes to sleep
+const int kSpinCount = 64;
+
+// chunks parallelFor makes per thread, so a slow chunk can be balanced out
+const unsigned int kChunksPerThread = 4;
+
+// JobSystem::shared()'s pool, at namespace scope so both are set up before
+// main rather than on the first call, VS2013 does not guard function local
+// statics against two threads getting there together
+std::once_flag shared_once;
+JobSystem* shared_instance = nullptr;
+
+} // end anonymous namespace
+
+JobSystem::Group::Group() : pending_(0)
+{
+    lock_.clear();
+}
+
+JobSystem::Group::~Group()
+{
+    assert(isDone());
+}
+
+bool JobSystem::Group::isDone() const
+{
+    return pending_.load() == 0;
+}
+
+JobSystem::Queue::Queue() : jobs_run(0), steals(0), idle_microseconds(0)
+{
+    lock.clear();
+}
+
+JobSystem::JobSystem(unsigned int worker_count) : queued_(0),
+                                                   sleepers_(0),
+                                                   stop_(false)
+{
+    if (worker_count == 0) {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = std::max(1u, hardware > 1 ? hardware - 1 : 1);
+    }
+    for (unsigned int i = 0; i <= worker_count; ++i) {
+        queues_.push_back(std::unique_ptr<Queue>(new Queue));
+    }
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::thread(&JobSystem::workerLoop, this, i));
+        worker_ids_.push_back(workers_.back().get_id());
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    stop_ = true;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::shared()
+{
+    // never destroyed, joining threads from static destructors can hang
+    std::call_once(shared_once, []{ shared_instance = new JobSystem(); });
+    return *shared_instance;
+}
+
+unsigned int JobSystem::getWorkerCount() const
+{
+    return (unsigned int)workers_.size();
+}
+
+void JobSystem::run(Group& group, std::function<void()> job)
+{
+    group.pending_++;
+    Job entry;
+    entry.group = &group;
+    entry.work = std::move(job);
+    push(queueIndex(), std::move(entry));
+}
+
+void JobSystem::runAfter(Group& dependency, Group& group,
+                         std::function<void()> job)
+{
+    assert(&dependency != &group);
+
+    group.pending_++;
+    {
+        SpinLock lock(dependency.lock_);
+        if (dependency.pending_.load() > 0) {
+            dependency.continuations_.push_back(
+                std::make_pair(&group, std::move(job)));
+            return;
+        }
+    }
+    Job entry;
+    entry.group = &group;
+    entry.work = std::move(job);
+    push(queueIndex(), std::move(entry));
+}
+
+void JobSystem::wait(Group& group)
+{
+    // threads outside the pool only help with their own group, so they
+    // never get stuck in someone else's long job
+    const size_t queue = queueIndex();
+    Group* only = queue == workers_.size() ? &group : nullptr;
+    while (group.pending_.load() > 0) {
+        Job job;
+        if (take(queue, job, only)) {
+            execute(queue, job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // the last job to finish holds the lock until it is done with the group
+    std::exception_ptr error;
+    {
+        SpinLock lock(group.lock_);
+        error.swap(group.error_);
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+    Stats stats;
+    stats.workers = getWorkerCount();
+    stats.jobs = 0;
+    stats.steals = 0;
+    unsigned long long idle = 0;
+    for (const auto& queue : queues_) {
+        stats.jobs += queue->jobs_run.load();
+        stats.steals += queue->steals.load();
+        idle += queue->idle_microseconds.load();
+    }
+    stats.idle_seconds = idle * 1e-6;
+    return stats;
+}
+
+void JobSystem::resetStats()
+{
+    for (auto& queue : queues_) {
+        queue->jobs_run = 0;
+        queue->steals = 0;
+        queue->idle_microseconds = 0;
+    }
+}
+
+JobSystem::BenchmarkResult JobSystem::benchmark(size_t jobs,
+                                                size_t work_per_job)
+{
+    std::vector<float> results(jobs);
+    auto work = [&results, work_per_job](size_t i) {
+        float x = (float)i;
+        for (size_t k = 0; k < work_per_job; ++k) {
+            x = x * 0.999f + 1.f;
+        }
+        results[i] = x;
+    };
+
+    BenchmarkResult result;
+    result.jobs = jobs;
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < jobs; ++i) {
+        work(i);
+    }
+    result.serial_seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    resetStats();
+    start = Clock::now();
+    Group group;
+    for (size_t i = 0; i < jobs; ++i) {
+        run(group, [&work, i]{ work(i); });
+    }
+    wait(group);
+    result.parallel_seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    result.stats = getStats();
+    return result;
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+    Queue& queue = *queues_[index];
+    while (!stop_) {
+        Job job;
+        if (take(index, job, nullptr)) {
+            execute(index, job);
+            continue;
+        }
+
+        // spin on the other queues for a while before sleeping, most jobs
+        // come in bursts
+        const Clock::time_point idle_start = Clock::now();
+        bool found = false;
+        for (int spin = 0; spin < kSpinCount && !found && !stop_; ++spin) {
+            std::this_thread::yield();
+            found = take(index, job, nullptr);
+        }
+        if (!found) {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleepers_++;
+            wake_.wait(lock, [this]{ return stop_ || queued_.load() > 0; });
+            sleepers_--;
+        }
+        queue.idle_microseconds += std::chrono::duration_cast<
+            std::chrono::microseconds>(Clock::now() - idle_start).count();
+        if (found) {
+            execute(index, job);
+        }
+    }
+}
+
+size_t JobSystem::queueIndex() const
+{
+    const std::thread::id id = std::this_thread::get_id();
+    for (size_t i = 0; i < worker_ids_.size(); ++i) {
+        if (worker_ids_[i] == id) return i;
+    }
+    return workers_.size();
+}
+
+void JobSystem::push(size_t queue, Job job)
+{
+    {
+        SpinLock lock(queues_[queue]->lock);
+        queues_[queue]->jobs.push_back(std::move(job));
+    }
+    queued_++;
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_.notify_one();
+    }
+}
+
+bool JobSystem::take(size_t queue, Job& job, Group* only)
+{
+    {
+        Queue& own = *queues_[queue];
+        SpinLock lock(own.lock);
+        if (!own.jobs.empty()
+            && (only == nullptr || own.jobs.back().group == only)) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+    if (only != nullptr) return false;
+
+    // steal the oldest job of the first queue that has one, skipping the
+    // ones someone else holds
+    const size_t count = queues_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Queue& victim = *queues_[(queue + offset) % count];
+        if (victim.lock.test_and_set(std::memory_order_acquire)) continue;
+        bool stolen = false;
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            stolen = true;
+        }
+        victim.lock.clear(std::memory_order_release);
+        if (stolen) {
+            queued_--;
+            queues_[queue]->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(size_t queue, Job& job)
+{
+    Group& group = *job.group;
+    std::exception_ptr error;
+    try {
+        job.work();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    job.work = nullptr;
+    queues_[queue]->jobs_run++;
+
+    // the group may be gone as soon as its count reaches zero and the lock
+    // is free, so finish everything with it under the lock
+    std::vector<std::pair<Group*, std::function<void()>>> continuations;
+    {
+        SpinLock lock(group.lock_);
+        if (error != nullptr && group.error_ == nullptr) {
+            group.error_ = error;
+        }
+        if (--group.pending_ == 0) {
+            continuations.swap(group.continuations_);
+        }
+    }
+    for (auto& continuation : continuations) {
+        Job next;
+        next.group = continuation.first;
+        next.work = std::move(continuation.second);
+        push(queue, std::move(next));
+    }
+}
+
+unsigned int JobSystem::chunkCount(size_t count, size_t grain) const
+{
+    const size_t chunks = count / std::max(grain, (size_t)1);
+    const size_t most = (workers_.size() + 1) * kChunksPerThread;
+    return (unsigned int)std::max((size_t)1, std::min(chunks, most));
+}
@@ -50,3 +50,13 @@ void Light::setIntensity(glm::vec3 i)
 {
     intensity = i;
 }
+
+const AnalyticMotion& Light::getMotion() const
+{
+    return motion;
+}
+
+void Light::setMotion(const AnalyticMotion& m)
+{
+    motion = m;
+}
@@ -0,0 +1,341 @@
+#include <SceneModel/LightIndex.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace SceneModel;
+
+namespace
+{
+
+const int kCoordBits = 21;
+const long long kCoordOffset = 1LL << (kCoordBits - 1);
+
+long long cellCoord(float value, float cell_size)
+{
+    const long long coord = (long long)std::floor(value / cell_size);
+    return std::min(std::max(coord, -kCoordOffset), kCoordOffset - 1);
+}
+
+bool sphereOverlapsBox(glm::vec3 centre, float radius,
+                       glm::vec3 box_min, glm::vec3 box_max)
+{
+    const glm::vec3 closest = glm::clamp(centre, box_min, box_max);
+    const glm::vec3 offset = centre - closest;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+bool sphereOverlapsFrustum(glm::vec3 centre, float radius,
+                           const LightIndex::Frustum& frustum)
+{
+    for (const auto& plane : frustum.planes) {
+        if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+glm::vec4 planeFacing(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 inside)
+{
+    const glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+    glm::vec4 plane(normal, -glm::dot(normal, a));
+    if (glm::dot(normal, inside) + plane.w < 0) {
+        plane = -plane;
+    }
+    return plane;
+}
+
+} // end anonymous namespace
+
+LightIndex::Frustum LightIndex::frustumSlice(const glm::mat4& projection,
+                                             const glm::mat4& view,
+                                             float near_distance,
+                                             float far_distance)
+{
+    const glm::mat4 inverse_projection = glm::inverse(projection);
+    const glm::mat4 inverse_view = glm::inverse(view);
+    const glm::vec2 ndc[4] = {
+        glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1)
+    };
+
+    Frustum frustum;
+    for (int i = 0; i < 4; ++i) {
+        // a point on the near plane gives the direction through the corner
+        glm::vec4 p = inverse_projection * glm::vec4(ndc[i], -1, 1);
+        const glm::vec3 ray = glm::vec3(p) / p.w;
+        const glm::vec3 near_corner = ray * (near_distance / -ray.z);
+        const glm::vec3 far_corner = ray * (far_distance / -ray.z);
+        frustum.corners[i] = glm::vec3(inverse_view * glm::vec4(near_corner, 1));
+        frustum.corners[i + 4] = glm::vec3(inverse_view * glm::vec4(far_corner, 1));
+    }
+
+    glm::vec3 centre(0);
+    for (const auto& corner : frustum.corners) {
+        centre += corner * 0.125f;
+    }
+    const glm::vec3* c = frustum.corners;
+    frustum.planes[0] = planeFacing(c[0], c[1], c[2], centre);
+    frustum.planes[1] = planeFacing(c[4], c[5], c[6], centre);
+    for (int i = 0; i < 4; ++i) {
+        const int j = (i + 1) % 4;
+        frustum.planes[2 + i] = planeFacing(c[i], c[j], c[j + 4], centre);
+    }
+    return frustum;
+}
+
+LightIndex::LightIndex(float smallest_cell_size)
+{
+    assert(smallest_cell_size > 0);
+    levels_.resize(kLevelCount);
+    for (int i = 0; i < kLevelCount; ++i) {
+        levels_[i].cell_size = smallest_cell_size * (1 << i);
+        levels_[i].max_range = 0;
+    }
+}
+
+int LightIndex::levelFor(float range) const
+{
+    for (int i = 0; i < kLevelCount; ++i) {
+        if (range <= levels_[i].cell_size) {
+            return i;
+        }
+    }
+    // bigger lights still work on the top level, the queries there just
+    // look further out
+    return kLevelCount - 1;
+}
+
+LightIndex::CellKey LightIndex::cellKey(const Level& level,
+                                        glm::vec3 position) const
+{
+    const long long x = cellCoord(position.x, level.cell_size) + kCoordOffset;
+    const long long y = cellCoord(position.y, level.cell_size) + kCoordOffset;
+    const long long z = cellCoord(position.z, level.cell_size) + kCoordOffset;
+    return (CellKey)x | ((CellKey)y << kCoordBits)
+        | ((CellKey)z << (2 * kCoordBits));
+}
+
+void LightIndex::update(size_t index, glm::vec3 position, float range)
+{
+    if (index >= entries_.size()) {
+        const Entry inactive = { glm::vec3(0), 0, 0, 0, false };
+        entries_.resize(index + 1, inactive);
+    }
+
+    const int level_index = levelFor(range);
+    Level& level = levels_[level_index];
+    const CellKey cell = cellKey(level, position);
+
+    Entry& entry = entries_[index];
+    const bool moved_cell = !entry.active || entry.level != level_index
+        || entry.cell != cell;
+    if (moved_cell && entry.active) {
+        remove(index);
+    }
+    entry.position = position;
+    entry.range = range;
+    entry.level = level_index;
+    entry.cell = cell;
+    entry.active = true;
+    level.max_range = std::max(level.max_range, range);
+    if (moved_cell) {
+        level.cells[cell].push_back(index);
+    }
+}
+
+void LightIndex::remove(size_t index)
+{
+    Entry& entry = entries_[index];
+    auto& cells = levels_[entry.level].cells;
+    auto found = cells.find(entry.cell);
+    assert(found != cells.end());
+    auto& lights = found->second;
+    auto light = std::find(lights.begin(), lights.end(), index);
+    assert(light != lights.end());
+    *light = lights.back();
+    lights.pop_back();
+    if (lights.empty()) {
+        cells.erase(found);
+    }
+    entry.active = false;
+}
+
+void LightIndex::resize(size_t count)
+{
+    for (size_t i = count; i < entries_.size(); ++i) {
+        if (entries_[i].active) {
+            remove(i);
+        }
+    }
+    if (count < entries_.size()) {
+        entries_.resize(count);
+    }
+}
+
+size_t LightIndex::size() const
+{
+    return entries_.size();
+}
+
+void LightIndex::clear()
+{
+    entries_.clear();
+    for (auto& level : levels_) {
+        level.cells.clear();
+        level.max_range = 0;
+    }
+}
+
+template<typename Test>
+void LightIndex::gather(glm::vec3 box_min, glm::vec3 box_max, Test test,
+                        std::vector<size_t>& lights) const
+{
+    for (const auto& level : levels_) {
+        if (level.cells.empty()) continue;
+
+        // a light in a cell outside the box grown by the longest range on
+        // the level can't reach the box
+        const glm::vec3 reach(level.max_range);
+        const glm::vec3 grown_min = box_min - reach;
+        const glm::vec3 grown_max = box_max + reach;
+        const long long x0 = cellCoord(grown_min.x, level.cell_size);
+        const long long y0 = cellCoord(grown_min.y, level.cell_size);
+        const long long z0 = cellCoord(grown_min.z, level.cell_size);
+        const long long x1 = cellCoord(grown_max.x, level.cell_size);
+        const long long y1 = cellCoord(grown_max.y, level.cell_size);
+        const long long z1 = cellCoord(grown_max.z, level.cell_size);
+        const double cell_count
+            = double(x1 - x0 + 1) * double(y1 - y0 + 1) * double(z1 - z0 + 1);
+
+        // big queries on small cells walk the occupied cells instead
+        if (cell_count > (double)level.cells.size()) {
+            for (const auto& cell : level.cells) {
+                for (size_t light : cell.second) {
+                    if (test(entries_[light])) {
+                        lights.push_back(light);
+                    }
+                }
+            }
+            continue;
+        }
+
+        for (long long z = z0; z <= z1; ++z) {
+            for (long long y = y0; y <= y1; ++y) {
+                for (long long x = x0; x <= x1; ++x) {
+                    const CellKey key = (CellKey)(x + kCoordOffset)
+                        | ((CellKey)(y + kCoordOffset) << kCoordBits)
+                        | ((CellKey)(z + kCoordOffset) << (2 * kCoordBits));
+                    auto cell = level.cells.find(key);
+                    if (cell == level.cells.end()) continue;
+                    for (size_t light : cell->second) {
+                        if (test(entries_[light])) {
+                            lights.push_back(light);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightIndex::appendBox(glm::vec3 box_min, glm::vec3 box_max,
+                           std::vector<size_t>& lights) const
+{
+    gather(box_min, box_max, [&](const Entry& entry) {
+        return sphereOverlapsBox(entry.position, entry.range,
+                                 box_min, box_max);
+    }, lights);
+}
+
+void LightIndex::appendSphere(glm::vec3 centre, float radius,
+                              std::vector<size_t>& lights) const
+{
+    gather(centre - glm::vec3(radius), centre + glm::vec3(radius),
+           [&](const Entry& entry) {
+        const glm::vec3 offset = entry.position - centre;
+        const float reach = entry.range + radius;
+        return glm::dot(offset, offset) <= reach * reach;
+    }, lights);
+}
+
+void LightIndex::appendFrustum(const Frustum& frustum,
+                               std::vector<size_t>& lights) const
+{
+    glm::vec3 box_min = frustum.corners[0];
+    glm::vec3 box_max = frustum.corners[0];
+    for (const auto& corner : frustum.corners) {
+        box_min = glm::min(box_min, corner);
+        box_max = glm::max(box_max, corner);
+    }
+    gather(box_min, box_max, [&](const Entry& entry) {
+        return sphereOverlapsBox(entry.position, entry.range,
+                                 box_min, box_max)
+            && sphereOverlapsFrustum(entry.position, entry.range, frustum);
+    }, lights);
+}
+
+void LightIndex::queryBox(glm::vec3 box_min, glm::vec3 box_max,
+                          std::vector<size_t>& lights) const
+{
+    lights.clear();
+    appendBox(box_min, box_max, lights);
+}
+
+void LightIndex::querySphere(glm::vec3 centre, float radius,
+                             std::vector<size_t>& lights) const
+{
+    lights.clear();
+    appendSphere(centre, radius, lights);
+}
+
+void LightIndex::queryFrustum(const Frustum& frustum,
+                              std::vector<size_t>& lights) const
+{
+    lights.clear();
+    appendFrustum(frustum, lights);
+}
+
+void LightIndex::queryBoxes(const glm::vec3* box_mins,
+                            const glm::vec3* box_maxs,
+                            size_t count,
+                            std::vector<size_t>& offsets,
+                            std::vector<size_t>& lights) const
+{
+    offsets.resize(count + 1);
+    offsets[0] = 0;
+    lights.clear();
+    for (size_t i = 0; i < count; ++i) {
+        appendBox(box_mins[i], box_maxs[i], lights);
+        offsets[i + 1] = lights.size();
+    }
+}
+
+void LightIndex::querySpheres(const glm::vec3* centres,
+                              const float* radii,
+                              size_t count,
+                              std::vector<size_t>& offsets,
+                              std::vector<size_t>& lights) const
+{
+    offsets.resize(count + 1);
+    offsets[0] = 0;
+    lights.clear();
+    for (size_t i = 0; i < count; ++i) {
+        appendSphere(centres[i], radii[i], lights);
+        offsets[i + 1] = lights.size();
+    }
+}
+
+void LightIndex::queryFrustums(const Frustum* frustums,
+                               size_t count,
+                               std::vector<size_t>& offsets,
+                               std::vector<size_t>& lights) const
+{
+    offsets.resize(count + 1);
+    offsets[0] = 0;
+    lights.clear();
+    for (size_t i = 0; i < count; ++i) {
+        appendFrustum(frustums[i], lights);
+        offsets[i + 1] = lights.size();
+    }
+}
@@ -0,0 +1,235 @@
+#include <SceneModel/Simulation.hpp>
+#include <SceneModel/Clock.hpp>
+#include <algorithm>
+#include <cassert>
+
+using namespace SceneModel;
+
+Simulation::Simulation(std::shared_ptr<Context> context, float timestep)
+    : context_(context),
+      timestep_(timestep),
+      created_(clockSeconds()),
+      next_step_(0),
+      virtual_clock_(false),
+      virtual_seconds_(0),
+      running_(false),
+      steps_(0),
+      acquired_light_generation_(0),
+      acquired_instance_version_(0),
+      has_snapshot_(false)
+{
+    assert(context_ != nullptr && timestep_ > 0);
+
+    const glm::mat4x3* transforms = context_->getInstanceTransformArray();
+    initial_transforms_.assign(transforms,
+                               transforms + context_->getInstanceCount());
+}
+
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start()
+{
+    if (running_) return;
+    assert(!virtual_clock_);
+    running_ = true;
+    next_step_ = getClockSeconds();
+    thread_ = std::thread(&Simulation::threadLoop, this);
+}
+
+void Simulation::stop()
+{
+    if (!running_) return;
+    running_ = false;
+    thread_.join();
+}
+
+bool Simulation::isRunning() const
+{
+    return running_;
+}
+
+void Simulation::advance()
+{
+    assert(!running_);
+
+    const double now = getClockSeconds();
+    if (next_step_ == 0) {
+        next_step_ = now;
+    }
+    int steps = 0;
+    while (next_step_ <= now && steps < kMaxCatchUpSteps) {
+        stepAndPublish();
+        next_step_ += timestep_;
+        ++steps;
+    }
+    if (next_step_ <= now) {
+        // too far behind, give up on the missed steps
+        next_step_ = now + timestep_;
+    }
+}
+
+float Simulation::getTimestep() const
+{
+    return timestep_;
+}
+
+void Simulation::setVirtualClock(bool virtual_clock)
+{
+    assert(!running_ && next_step_ == 0);
+    virtual_clock_ = virtual_clock;
+    virtual_seconds_ = 0;
+}
+
+bool Simulation::hasVirtualClock() const
+{
+    return virtual_clock_;
+}
+
+void Simulation::advanceClock(double seconds)
+{
+    assert(virtual_clock_ && seconds >= 0);
+    virtual_seconds_ = virtual_seconds_ + seconds;
+}
+
+void Simulation::post(std::function<void(Context&)> command)
+{
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    commands_.push_back(std::move(command));
+}
+
+unsigned int Simulation::getStepCount() const
+{
+    return steps_;
+}
+
+void Simulation::setStepCallback(std::function<void(unsigned int)> callback)
+{
+    step_callback_ = callback;
+}
+
+void Simulation::setPublishCallback(std::function<void(const Snapshot&)> callback)
+{
+    publish_callback_ = callback;
+}
+
+void Simulation::threadLoop()
+{
+    while (running_) {
+        int steps = 0;
+        while (next_step_ <= getClockSeconds()
+               && steps < kMaxCatchUpSteps) {
+            stepAndPublish();
+            next_step_ += timestep_;
+            ++steps;
+        }
+        const double now = getClockSeconds();
+        if (next_step_ <= now) {
+            next_step_ = now + timestep_;
+        }
+        std::this_thread::sleep_for(
+            std::chrono::duration<double>(next_step_ - now));
+    }
+}
+
+void Simulation::stepAndPublish()
+{
+    if (step_callback_) {
+        step_callback_(steps_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        running_commands_.swap(commands_);
+    }
+    for (auto& command : running_commands_) {
+        command(*context_);
+    }
+    running_commands_.clear();
+
+    context_->step(timestep_);
+    ++steps_;
+
+    Snapshot& snapshot = snapshots_.writeSlot();
+    snapshot.time = context_->getTimeInSeconds();
+    snapshot.published = getClockSeconds();
+    snapshot.camera = context_->getCamera();
+    snapshot.camera_version = context_->getVersion(Context::kCameraClass);
+    snapshot.lights = context_->getAllLights();
+    context_->getLightsChangedSince(acquired_light_generation_,
+                                    snapshot.light_changes);
+
+    const auto& dynamic = context_->getDynamicInstanceIndices();
+    const glm::mat4x3* transforms = context_->getInstanceTransformArray();
+    snapshot.dynamic_transforms.resize(dynamic.size());
+    for (size_t i = 0; i < dynamic.size(); ++i) {
+        snapshot.dynamic_transforms[i] = transforms[dynamic[i]];
+    }
+    snapshot.instance_version = context_->getVersion(Context::kInstanceClass);
+    context_->getDirtyRangesSince(Context::kInstanceClass,
+                                  acquired_instance_version_,
+                                  snapshot.dirty_instances);
+    snapshot.scene_version = snapshot.camera_version
+        + snapshot.instance_version
+        + context_->getVersion(Context::kLightClass)
+        + context_->getVersion(Context::kMaterialClass);
+
+    snapshots_.publish();
+    if (publish_callback_) {
+        publish_callback_(snapshot);
+    }
+}
+
+bool Simulation::latestSnapshots(const Snapshot*& previous,
+                                 const Snapshot*& current)
+{
+    // only this thread clears the fresh flag, so a fresh snapshot seen here
+    // is still there to acquire
+    if (snapshots_.hasFresh()) {
+        // keep a copy of the current one, its slot goes back to the writer
+        if (has_snapshot_) {
+            previous_ = snapshots_.readSlot();
+        }
+        snapshots_.acquire();
+        if (!has_snapshot_) {
+            previous_ = snapshots_.readSlot();
+            has_snapshot_ = true;
+        }
+        acquired_light_generation_
+            = snapshots_.readSlot().light_changes.generation;
+        acquired_instance_version_
+            = snapshots_.readSlot().instance_version;
+    }
+    if (!has_snapshot_) {
+        return false;
+    }
+    previous = &previous_;
+    current = &snapshots_.readSlot();
+    return true;
+}
+
+float Simulation::interpolationFactor(const Snapshot& previous,
+                                      const Snapshot& current) const
+{
+    const double span = current.published - previous.published;
+    if (span <= 0) {
+        return 1.f;
+    }
+    const double render_time = getClockSeconds() - timestep_;
+    const double t = (render_time - previous.published) / span;
+    return (float)std::min(1.0, std::max(0.0, t));
+}
+
+const std::vector<glm::mat4x3>& Simulation::getInitialTransforms() const
+{
+    return initial_transforms_;
+}
+
+double Simulation::getClockSeconds() const
+{
+    if (virtual_clock_) {
+        return virtual_seconds_;
+    }
+    return clockSeconds() - created_;
+}
@@ -0,0 +1,281 @@
+#include <SceneModel/TransformHierarchy.hpp>
+#include <SceneModel/JobSystem.hpp>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+using namespace SceneModel;
+
+const TransformHierarchy::Node TransformHierarchy::kNoParent;
+const size_t TransformHierarchy::kParallelThreshold;
+
+namespace
+{
+
+// both are affine, the implied last row is 0 0 0 1
+glm::mat4x3 compose(const glm::mat4x3& parent, const glm::mat4x3& local)
+{
+    glm::mat4x3 world;
+    for (int i = 0; i < 4; ++i) {
+        world[i] = parent[0] * local[i].x + parent[1] * local[i].y
+            + parent[2] * local[i].z;
+    }
+    world[3] += parent[3];
+    return world;
+}
+
+} // end anonymous namespace
+
+TransformHierarchy::TransformHierarchy() : layout_dirty_(false)
+{
+}
+
+TransformHierarchy::Node TransformHierarchy::addNode(Node parent,
+                                                     const glm::mat4x3& local)
+{
+    assert(parent == kNoParent || parent < parents_.size());
+
+    // goes on the end until the next update() puts it in its place
+    const Node node = parents_.size();
+    parents_.push_back(parent);
+    positions_.push_back(nodes_.size());
+    nodes_.push_back(node);
+    parent_positions_.push_back(parent == kNoParent ? kNoParent
+                                                    : positions_[parent]);
+    first_children_.push_back(0);
+    child_counts_.push_back(0);
+    locals_.push_back(local);
+    worlds_.push_back(parent == kNoParent ? local
+                                          : compose(getWorld(parent), local));
+    dirty_.push_back(1);
+    dirty_nodes_.push_back(node);
+    layout_dirty_ = true;
+    return node;
+}
+
+void TransformHierarchy::setParent(Node node, Node parent)
+{
+    assert(node < parents_.size());
+    assert(parent == kNoParent || parent < parents_.size());
+    if (parents_[node] == parent) return;
+
+    for (Node ancestor = parent; ancestor != kNoParent;
+         ancestor = parents_[ancestor]) {
+        if (ancestor == node) {
+            throw std::invalid_argument("Transform node can't be its own "
+                                        "ancestor");
+        }
+    }
+    parents_[node] = parent;
+    parent_positions_[positions_[node]] = parent == kNoParent
+        ? kNoParent : positions_[parent];
+    setLocal(node, getLocal(node));
+    layout_dirty_ = true;
+}
+
+TransformHierarchy::Node TransformHierarchy::getParent(Node node) const
+{
+    return parents_[node];
+}
+
+void TransformHierarchy::setLocal(Node node, const glm::mat4x3& local)
+{
+    const size_t position = positions_[node];
+    locals_[position] = local;
+    if (!dirty_[position]) {
+        dirty_[position] = 1;
+        dirty_nodes_.push_back(node);
+    }
+}
+
+const glm::mat4x3& TransformHierarchy::getLocal(Node node) const
+{
+    return locals_[positions_[node]];
+}
+
+const glm::mat4x3& TransformHierarchy::getWorld(Node node) const
+{
+    return worlds_[positions_[node]];
+}
+
+void TransformHierarchy::update()
+{
+    updated_.clear();
+    if (layout_dirty_) {
+        rebuild();
+    }
+    if (dirty_nodes_.empty()) return;
+
+    // the nodes set since the last update, by level
+    const size_t level_count = getLevelCount();
+    pending_.resize(level_count);
+    for (Node node : dirty_nodes_) {
+        const size_t position = positions_[node];
+        const size_t level = std::upper_bound(level_offsets_.begin(),
+                                              level_offsets_.end(),
+                                              position)
+            - level_offsets_.begin() - 1;
+        pending_[level].push_back(position);
+    }
+    dirty_nodes_.clear();
+
+    // each level redoes its own dirty nodes and the children of everything
+    // redone on the level above, which are all next to each other
+    previous_.clear();
+    for (size_t level = 0; level < level_count; ++level) {
+        current_.swap(pending_[level]);
+        pending_[level].clear();
+        for (size_t parent : previous_) {
+            const size_t first = first_children_[parent];
+            const size_t end = first + child_counts_[parent];
+            for (size_t child = first; child < end; ++child) {
+                if (!dirty_[child]) {
+                    dirty_[child] = 1;
+                    current_.push_back(child);
+                }
+            }
+        }
+        updatePositions(current_.data(), current_.size());
+        previous_.swap(current_);
+        for (size_t position : previous_) {
+            updated_.push_back(nodes_[position]);
+        }
+    }
+    current_.clear();
+
+    for (Node node : updated_) {
+        dirty_[positions_[node]] = 0;
+    }
+}
+
+void TransformHierarchy::updatePositions(const size_t* positions,
+                                         size_t count)
+{
+    JobSystem::shared().parallelFor(0, count, kParallelThreshold,
+        [this, positions](size_t begin, size_t end) {
+            computeWorlds(positions + begin, end - begin);
+        });
+}
+
+void TransformHierarchy::computeWorlds(const size_t* positions, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const size_t position = positions[i];
+        const size_t parent = parent_positions_[position];
+        worlds_[position] = parent == kNoParent ? locals_[position]
+            : compose(worlds_[parent], locals_[position]);
+    }
+}
+
+const std::vector<TransformHierarchy::Node>&
+TransformHierarchy::getUpdatedNodes() const
+{
+    return updated_;
+}
+
+size_t TransformHierarchy::size() const
+{
+    return parents_.size();
+}
+
+size_t TransformHierarchy::getLevelCount() const
+{
+    assert(!layout_dirty_);
+    return level_offsets_.empty() ? 0 : level_offsets_.size() - 1;
+}
+
+void TransformHierarchy::clear()
+{
+    parents_.clear();
+    positions_.clear();
+    dirty_nodes_.clear();
+    nodes_.clear();
+    parent_positions_.clear();
+    first_children_.clear();
+    child_counts_.clear();
+    locals_.clear();
+    worlds_.clear();
+    dirty_.clear();
+    level_offsets_.clear();
+    pending_.clear();
+    updated_.clear();
+    layout_dirty_ = false;
+}
+
+void TransformHierarchy::rebuild()
+{
+    const size_t count = parents_.size();
+
+    // children of each node in node order
+    std::vector<size_t> child_offsets(count + 1, 0);
+    for (Node node = 0; node < count; ++node) {
+        if (parents_[node] != kNoParent) {
+            ++child_offsets[parents_[node] + 1];
+        }
+    }
+    for (Node node = 0; node < count; ++node) {
+        child_offsets[node + 1] += child_offsets[node];
+    }
+    std::vector<Node> children(child_offsets[count]);
+    std::vector<size_t> fill(child_offsets.begin(), child_offsets.end() - 1);
+    for (Node node = 0; node < count; ++node) {
+        if (parents_[node] != kNoParent) {
+            children[fill[parents_[node]]++] = node;
+        }
+    }
+
+    // every root first, then a breadth-first walk appending each node's
+    // children together
+    std::vector<Node> order;
+    order.reserve(count);
+    for (Node node = 0; node < count; ++node) {
+        if (parents_[node] == kNoParent) {
+            order.push_back(node);
+        }
+    }
+    std::vector<size_t> first_children(count);
+    std::vector<size_t> child_counts(count);
+    level_offsets_.assign(1, 0);
+    size_t level_end = order.size();
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == level_end) {
+            level_offsets_.push_back(i);
+            level_end = order.size();
+        }
+        const Node node = order[i];
+        first_children[i] = order.size();
+        child_counts[i] = child_offsets[node + 1] - child_offsets[node];
+        order.insert(order.end(), children.begin() + child_offsets[node],
+                     children.begin() + child_offsets[node + 1]);
+    }
+    level_offsets_.push_back(order.size());
+    if (count == 0) {
+        level_offsets_.clear();
+    }
+    assert(order.size() == count);
+
+    std::vector<glm::mat4x3> locals(count);
+    std::vector<glm::mat4x3> worlds(count);
+    std::vector<unsigned char> dirty(count);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t old_position = positions_[order[i]];
+        locals[i] = locals_[old_position];
+        worlds[i] = worlds_[old_position];
+        dirty[i] = dirty_[old_position];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        positions_[order[i]] = i;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const Node parent = parents_[order[i]];
+        parent_positions_[i] = parent == kNoParent ? kNoParent
+                                                   : positions_[parent];
+    }
+    nodes_.swap(order);
+    first_children_.swap(first_children);
+    child_counts_.swap(child_counts);
+    locals_.swap(locals);
+    worlds_.swap(worlds);
+    dirty_.swap(dirty);
+    layout_dirty_ = false;
+}
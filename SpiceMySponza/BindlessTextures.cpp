@@ -0,0 +1,154 @@
+#include "BindlessTextures.hpp"
+#include <tygra/FileHelper.hpp>
+#include <tygra/TextureContainer.hpp>
+
+BindlessTextures::BindlessTextures()
+{
+}
+
+BindlessTextures::~BindlessTextures()
+{
+}
+
+void BindlessTextures::addTexture(const std::string& filepath)
+{
+	if (handles_.find(filepath) != handles_.end()){
+		return;
+	}
+	handles_.insert({ filepath, 0 });
+	filepaths_.push_back(filepath);
+	sources_.push_back(nullptr);
+}
+
+int BindlessTextures::textureCount() const
+{
+	return filepaths_.size();
+}
+
+void BindlessTextures::decodeTexture(int index)
+{
+	const std::string& filepath = filepaths_[index];
+
+	//a container next to the PNG already holds the whole mip chain
+	tygra::TextureContainer container;
+	if (container.open(tygra::containerPathForPNG(filepath))
+		&& (!container.isCompressed()
+			|| tglIsAvailable(TGL_EXTENSION_EXT_TEXTURE_COMPRESSION_S3TC))) {
+		sources_[index].reset(new Source(std::move(container), tygra::Image()));
+		return;
+	}
+	sources_[index].reset(new Source(tygra::TextureContainer(),
+									 tygra::imageFromPNG(filepath)));
+}
+
+void BindlessTextures::upload()
+{
+	for (int i = 0; i < textureCount(); i++){
+		GLuint64& texture_handle = handles_[filepaths_[i]];
+		if (texture_handle != 0){
+			continue;
+		}
+		if (sources_[i] == nullptr){
+			decodeTexture(i);
+		}
+
+		const GLuint texture = uploadTexture(*sources_[i]);
+		sources_[i].reset();
+		if (texture != 0) {
+			//the texture's state is frozen from here on
+			texture_handle = glGetTextureHandleARB(texture);
+			glMakeTextureHandleResidentARB(texture_handle);
+			textures_.push_back(texture);
+		}
+	}
+}
+
+GLuint BindlessTextures::uploadTexture(const Source& source)
+{
+	GLuint texture = 0;
+
+	const tygra::TextureContainer& container = source.container;
+	if (container.isOpen()) {
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+			container.levelCount() - 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (unsigned int i = 0; i < container.levelCount(); i++){
+			if (container.isCompressed()) {
+				glCompressedTexImage2D(GL_TEXTURE_2D,
+					i,
+					container.glInternalFormat(),
+					container.levelWidth(i),
+					container.levelHeight(i),
+					0,
+					container.levelSize(i),
+					container.levelData(i));
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D,
+					i,
+					container.glInternalFormat(),
+					container.levelWidth(i),
+					container.levelHeight(i),
+					0,
+					container.glFormat(),
+					container.glType(),
+					container.levelData(i));
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else {
+		const tygra::Image& texture_image = source.image;
+
+		if (texture_image.containsData()) {
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+			glTexImage2D(GL_TEXTURE_2D,
+				0,
+				GL_RGBA,
+				texture_image.width(),
+				texture_image.height(),
+				0,
+				pixel_formats[texture_image.componentsPerPixel()],
+				texture_image.bytesPerComponent() == 1 ? GL_UNSIGNED_BYTE
+				: GL_UNSIGNED_SHORT,
+				texture_image.pixels());
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+	}
+
+	if (texture != 0) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+			GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	return texture;
+}
+
+GLuint64 BindlessTextures::handle(const std::string& filepath) const
+{
+	auto got = handles_.find(filepath);
+	return got == handles_.end() ? 0 : got->second;
+}
+
+void BindlessTextures::clear()
+{
+	for (const auto& texture_handle : handles_){
+		if (texture_handle.second != 0){
+			glMakeTextureHandleNonResidentARB(texture_handle.second);
+		}
+	}
+	if (!textures_.empty()){
+		glDeleteTextures(textures_.size(), textures_.data());
+	}
+	handles_.clear();
+	textures_.clear();
+	filepaths_.clear();
+	sources_.clear();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <tgl/tgl.h>
+#include <tygra/TextureContainer.hpp>
+#include <tygra/Image.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/*
+Loads textures and keeps a resident ARB_bindless_texture handle for each.
+
+Only use this when tglIsAvailable(TGL_EXTENSION_ARB_BINDLESS_TEXTURE) is
+true. The handles are written into a buffer the shader reads from, so once
+loaded a texture never has to be bound or assigned to a sampler uniform.
+
+Like TextureArrays, the files can be decoded on other threads with
+decodeTexture() before upload() creates the textures on the GL thread.
+*/
+class BindlessTextures
+{
+public:
+
+	BindlessTextures();
+
+	~BindlessTextures();
+
+	//register a texture, its handle exists after the next upload()
+	void addTexture(const std::string& filepath);
+
+	int textureCount() const;
+
+	//read the container or PNG of one added texture, no GL calls so any
+	//thread may decode any index as long as no two decode the same one
+	void decodeTexture(int index);
+
+	//create every added texture with a full mip chain and make its handle
+	//resident, any texture not decoded yet is decoded here first
+	void upload();
+
+	//resident handle for the texture, 0 if it is missing or failed to load
+	GLuint64 handle(const std::string& filepath) const;
+
+	//make every handle non-resident and delete the textures
+	void clear();
+
+private:
+
+	//each file has either an open container or a decoded image
+	struct Source
+	{
+		tygra::TextureContainer container;
+		tygra::Image image;
+
+		Source(tygra::TextureContainer&& container, tygra::Image&& image)
+			: container(std::move(container)), image(std::move(image)){}
+	};
+
+	//returns the new texture object, 0 if nothing was decoded
+	GLuint uploadTexture(const Source& source);
+
+	std::vector<std::string> filepaths_;
+	std::vector<std::unique_ptr<Source>> sources_;
+	std::unordered_map<std::string, GLuint64> handles_;
+	std::vector<GLuint> textures_;
+
+};
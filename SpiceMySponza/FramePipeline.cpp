@@ -0,0 +1,105 @@
+#include "FramePipeline.hpp"
+#include <tygra/FrameScheduler.hpp>
+#include <algorithm>
+
+const int FramePipeline::kMaxFramesInFlight;
+
+//longest single wait on a fence before asking again, in nanoseconds
+static const GLuint64 kFenceWaitTimeout = 1000000;
+
+FramePipeline::FramePipeline(int frames_in_flight) :
+	current_(0),
+	last_gpu_end_(0)
+{
+	slots_.resize(std::min(std::max(frames_in_flight, 1), kMaxFramesInFlight));
+	for (auto& slot : slots_){
+		slot.fence = 0;
+		glGenQueries(1, &slot.begin_query);
+		glGenQueries(1, &slot.end_query);
+	}
+	resetStats();
+}
+
+FramePipeline::~FramePipeline()
+{
+	clear();
+}
+
+int FramePipeline::framesInFlight() const
+{
+	return (int)slots_.size();
+}
+
+int FramePipeline::beginFrame()
+{
+	current_ = (current_ + 1) % slots_.size();
+	Slot& slot = slots_[current_];
+	retire(slot);
+	glQueryCounter(slot.begin_query, GL_TIMESTAMP);
+	return current_;
+}
+
+void FramePipeline::endFrame()
+{
+	Slot& slot = slots_[current_];
+	glQueryCounter(slot.end_query, GL_TIMESTAMP);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+FramePipeline::Stats FramePipeline::getStats() const
+{
+	return stats_;
+}
+
+void FramePipeline::resetStats()
+{
+	stats_.frames_in_flight = (int)slots_.size();
+	stats_.frames = 0;
+	stats_.cpu_wait_seconds = 0;
+	stats_.gpu_busy_seconds = 0;
+	stats_.gpu_idle_seconds = 0;
+}
+
+void FramePipeline::clear()
+{
+	//oldest first so the idle gaps still line up
+	for (size_t i = 1; i <= slots_.size(); i++){
+		retire(slots_[(current_ + i) % slots_.size()]);
+	}
+	for (auto& slot : slots_){
+		glDeleteQueries(1, &slot.begin_query);
+		glDeleteQueries(1, &slot.end_query);
+	}
+	slots_.clear();
+	current_ = 0;
+}
+
+void FramePipeline::retire(Slot& slot)
+{
+	if (slot.fence == 0){
+		return;
+	}
+
+	//the flush makes sure the fence is on its way to the GPU at all
+	const double wait_start = tygra::FrameScheduler::now();
+	while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+							kFenceWaitTimeout) == GL_TIMEOUT_EXPIRED){
+	}
+	stats_.cpu_wait_seconds += tygra::FrameScheduler::now() - wait_start;
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+
+	//the frame is finished so its timestamps are ready without stalling
+	GLuint64 gpu_begin = 0;
+	GLuint64 gpu_end = 0;
+	glGetQueryObjectui64v(slot.begin_query, GL_QUERY_RESULT, &gpu_begin);
+	glGetQueryObjectui64v(slot.end_query, GL_QUERY_RESULT, &gpu_end);
+	if (gpu_end > gpu_begin){
+		stats_.gpu_busy_seconds += (gpu_end - gpu_begin) * 1e-9;
+	}
+	if (last_gpu_end_ != 0 && gpu_begin > last_gpu_end_){
+		stats_.gpu_idle_seconds += (gpu_begin - last_gpu_end_) * 1e-9;
+	}
+	last_gpu_end_ = gpu_end;
+	stats_.frames++;
+}
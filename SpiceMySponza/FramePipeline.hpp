@@ -0,0 +1,75 @@
+#pragma once
+
+#include <tgl/tgl.h>
+#include <vector>
+
+/*
+Lets the CPU build a few frames ahead of the GPU without either side guessing
+what the other is doing. Every frame in flight has a slot with a fence after
+its last command and timestamp queries around its commands. beginFrame() waits
+on the fence of the slot it is about to reuse, so whatever that frame wrote
+into the slot's resources can be overwritten straight away, with no implicit
+sync or buffer renaming left to the driver.
+
+The time spent waiting there is the CPU waiting for the GPU. The gap between
+the last timestamp of one frame and the first of the next is the GPU waiting
+for the CPU, swapping buffers included. Whichever is bigger says what bounds
+the frame rate.
+
+All methods must be called from the GL thread.
+*/
+class FramePipeline
+{
+public:
+
+	struct Stats
+	{
+		int frames_in_flight;
+		int frames;
+		double cpu_wait_seconds;
+		double gpu_busy_seconds;
+		double gpu_idle_seconds;
+	};
+
+	static const int kMaxFramesInFlight = 4;
+
+	//frames_in_flight is clamped to 1 to kMaxFramesInFlight
+	explicit FramePipeline(int frames_in_flight);
+
+	~FramePipeline();
+
+	int framesInFlight() const;
+
+	//waits until the GPU has finished the oldest frame and returns its slot,
+	//0 to framesInFlight() - 1, for this frame's per frame resources
+	int beginFrame();
+
+	//fences everything issued since beginFrame()
+	void endFrame();
+
+	//totals over the frames the GPU finished since the last reset
+	Stats getStats() const;
+
+	void resetStats();
+
+	//wait for every frame in flight then delete the fences and queries
+	void clear();
+
+private:
+
+	struct Slot
+	{
+		GLsync fence;
+		GLuint begin_query;
+		GLuint end_query;
+	};
+
+	//wait on the slot's fence and add its timings to the stats
+	void retire(Slot& slot);
+
+	std::vector<Slot> slots_;
+	int current_;
+	//GPU timestamp of the end of the last retired frame, 0 before the first
+	GLuint64 last_gpu_end_;
+	Stats stats_;
+};
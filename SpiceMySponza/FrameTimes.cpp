@@ -0,0 +1,86 @@
+#include "FrameTimes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+FrameTimes::FrameTimes() : sorted_valid_(true)
+{
+}
+
+void FrameTimes::add(double seconds)
+{
+	times_.push_back(seconds);
+	sorted_valid_ = false;
+}
+
+size_t FrameTimes::count() const
+{
+	return times_.size();
+}
+
+double FrameTimes::mean() const
+{
+	if (times_.empty()){
+		return 0;
+	}
+	double total = 0;
+	for (double time : times_){
+		total += time;
+	}
+	return total / times_.size();
+}
+
+double FrameTimes::variance() const
+{
+	if (times_.size() < 2){
+		return 0;
+	}
+	const double average = mean();
+	double squares = 0;
+	for (double time : times_){
+		squares += (time - average) * (time - average);
+	}
+	return squares / (times_.size() - 1);
+}
+
+double FrameTimes::percentile(double p) const
+{
+	if (times_.empty()){
+		return 0;
+	}
+	if (!sorted_valid_){
+		sorted_ = times_;
+		std::sort(sorted_.begin(), sorted_.end());
+		sorted_valid_ = true;
+	}
+	const double rank = std::ceil(p / 100 * sorted_.size());
+	const size_t index = (size_t)std::max(rank, 1.0) - 1;
+	return sorted_[std::min(index, sorted_.size() - 1)];
+}
+
+double FrameTimes::longest() const
+{
+	return percentile(100);
+}
+
+void FrameTimes::clear()
+{
+	times_.clear();
+	sorted_.clear();
+	sorted_valid_ = true;
+}
+
+void FrameTimes::report(std::ostream& out) const
+{
+	const std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(3)
+		<< count() << " frames, ms mean " << 1000 * mean()
+		<< " sd " << 1000 * std::sqrt(variance())
+		<< " p50 " << 1000 * percentile(50)
+		<< " p90 " << 1000 * percentile(90)
+		<< " p95 " << 1000 * percentile(95)
+		<< " p99 " << 1000 * percentile(99)
+		<< " max " << 1000 * longest() << std::endl;
+	out.unsetf(std::ios::fixed);
+	out.precision(precision);
+}
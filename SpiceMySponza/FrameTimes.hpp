@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+/*
+Collects the duration of every frame of a run and summarises them the way
+benchmarks are compared: mean and percentiles, so one long frame shows up
+instead of vanishing into an average.
+*/
+class FrameTimes
+{
+public:
+
+	FrameTimes();
+
+	void add(double seconds);
+
+	size_t count() const;
+
+	double mean() const;
+
+	//sample variance in seconds squared, zero with fewer than two frames
+	double variance() const;
+
+	//nearest rank, p from 0 to 100, zero without any frames
+	double percentile(double p) const;
+
+	double longest() const;
+
+	void clear();
+
+	//one line of milliseconds: frames, mean, standard deviation, p50, p90,
+	//p95, p99, max
+	void report(std::ostream& out) const;
+
+private:
+
+	std::vector<double> times_;
+	//times_ sorted, only rebuilt when a frame was added since
+	mutable std::vector<double> sorted_;
+	mutable bool sorted_valid_;
+
+};
@@ -0,0 +1,42 @@
+#include "InputRecording.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+bool saveInputRecording(const std::string& filepath,
+						const std::vector<InputEvent>& events)
+{
+	std::ofstream file(filepath);
+	if (!file){
+		return false;
+	}
+	//enough digits that values read back exactly
+	file << std::setprecision(9);
+	for (const auto& event : events){
+		file << event.step << ' ' << (int)event.kind << ' '
+			<< event.index << ' ' << event.value << '\n';
+	}
+	return (bool)file;
+}
+
+bool loadInputRecording(const std::string& filepath,
+						std::vector<InputEvent>& events)
+{
+	events.clear();
+	std::ifstream file(filepath);
+	if (!file){
+		return false;
+	}
+	InputEvent event;
+	int kind;
+	while (file >> event.step >> kind >> event.index >> event.value){
+		if (kind < InputEvent::kMouseMoved || kind > InputEvent::kGamepadButton){
+			continue;
+		}
+		event.kind = (InputEvent::Kind)kind;
+		events.push_back(event);
+	}
+	std::stable_sort(events.begin(), events.end(),
+		[](const InputEvent& a, const InputEvent& b){ return a.step < b.step; });
+	return true;
+}
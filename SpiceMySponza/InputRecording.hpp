@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+The controller's input as a list of events stamped with the simulation step
+they took effect on, so a session can be saved and fed back through the same
+handlers later. A replay delivers every event at the start of the same step,
+whatever the frame rate or clock either run had.
+
+Recordings are plain text, one event per line: step, kind, index, value.
+*/
+struct InputEvent
+{
+	enum Kind
+	{
+		kMouseMoved,		//index x, value y
+		kMouseButton,		//index button, value down
+		kMouseWheel,		//index position
+		kKeyboard,			//index key, value down
+		kGamepadAxis,		//index gamepad * 256 + axis, value position
+		kGamepadButton		//index gamepad * 256 + button, value down
+	};
+
+	unsigned int step;
+	Kind kind;
+	int index;
+	float value;
+};
+
+bool saveInputRecording(const std::string& filepath,
+						const std::vector<InputEvent>& events);
+
+//events come back in step order, false if the file can't be read
+bool loadInputRecording(const std::string& filepath,
+						std::vector<InputEvent>& events);
@@ -3,9 +3,65 @@
 #include <SceneModel/SceneModel.hpp>
 #include <tygra/Window.hpp>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+//how far the virtual clock moves each frame of a benchmark run
+static const double kBenchmarkFrameInterval = 1.0 / 60;
+
+static void reportJobStats(std::ostream& out, const SceneModel::JobSystem::Stats& stats)
+{
+	out << stats.jobs << " jobs, " << stats.steals << " steals, "
+		<< stats.idle_seconds << "s idle over " << stats.workers << " workers" << std::endl;
+}
+
+//per frame averages, whichever side waited longer for the other is the one
+//the frame rate is not bound by
+static void reportFrameStats(std::ostream& out, const FramePipeline::Stats& stats)
+{
+	const double frames = std::max(stats.frames, 1);
+	out << stats.frames_in_flight << " frames in flight, ms per frame: CPU waiting "
+		<< stats.cpu_wait_seconds / frames * 1e3 << ", GPU busy "
+		<< stats.gpu_busy_seconds / frames * 1e3 << ", GPU idle "
+		<< stats.gpu_idle_seconds / frames * 1e3 << ", "
+		<< (stats.cpu_wait_seconds > stats.gpu_idle_seconds ? "GPU" : "CPU")
+		<< " bound" << std::endl;
+}
+
+//frame to frame intervals as the window's scheduler saw them
+static void reportPacingStats(std::ostream& out, const tygra::FrameScheduler::Stats& stats)
+{
+	out << stats.frames << " frames, ms mean " << stats.mean_seconds * 1e3
+		<< " sd " << std::sqrt(stats.variance) * 1e3
+		<< " min " << stats.shortest_seconds * 1e3
+		<< " max " << stats.longest_seconds * 1e3 << std::endl;
+}
+
+//many small jobs of growing size, serially and on the job system, to see
+//where the scheduling overhead stops mattering
+static void runJobBenchmark()
+{
+	SceneModel::JobSystem& jobs = SceneModel::JobSystem::shared();
+	const size_t kJobs = 20000;
+	const size_t work_sizes[] = { 0, 100, 1000, 10000 };
+	for (size_t work : work_sizes){
+		const auto result = jobs.benchmark(kJobs, work);
+		std::cout << "Jobs of " << work << " multiply-adds: serial "
+			<< result.serial_seconds * 1e3 << "ms, parallel "
+			<< result.parallel_seconds * 1e3 << "ms, "
+			<< result.parallel_seconds / result.jobs * 1e6 << "us per job, speedup "
+			<< result.serial_seconds / result.parallel_seconds << std::endl << "  ";
+		reportJobStats(std::cout, result.stats);
+	}
+}
 
 MyController::
-MyController() : camera_turn_mode_(false)
+MyController(const std::vector<std::string>& options) : camera_turn_mode_(false),
+	next_replay_event_(0), replaying_(false), dispatching_replay_(false),
+	benchmark_(false), benchmark_frames_(1000), close_at_start_(false),
+	frame_count_(0), frame_start_(0)
 {
 	camera_move_speed_[0] = 0;
 	camera_move_speed_[1] = 0;
@@ -13,9 +69,111 @@ MyController() : camera_turn_mode_(false)
 	camera_move_speed_[3] = 0;
 	camera_rotate_speed_[0] = 0;
 	camera_rotate_speed_[1] = 0;
-	scene_ = std::make_shared<SceneModel::Context>();
+
+	auto hasOption = [&options](const char* name) {
+		return std::find(options.begin(), options.end(), name) != options.end();
+	};
+	//the option after name, or an empty string
+	auto optionValue = [&options](const char* name) {
+		auto found = std::find(options.begin(), options.end(), name);
+		return found != options.end() && found + 1 != options.end()
+			? *(found + 1) : std::string();
+	};
+
+	//scaled up scenes for benchmarking, the defaults load just the file
+	SceneModel::SceneDescription description;
+	const std::string grid = optionValue("--grid");
+	if (!grid.empty()){
+		const size_t x = grid.find('x');
+		description.grid_columns = std::max(std::atoi(grid.c_str()), 1);
+		description.grid_rows = x == std::string::npos ? description.grid_columns
+			: std::max(std::atoi(grid.c_str() + x + 1), 1);
+	}
+	description.unique_meshes = hasOption("--unique-meshes");
+	description.scattered_lights = std::max(std::atoi(optionValue("--lights").c_str()), 0);
+	const std::string materials = optionValue("--materials");
+	if (!materials.empty()){
+		description.material_count = std::atoi(materials.c_str());
+	}
+
+	scene_ = std::make_shared<SceneModel::Context>(description);
+	simulation_ = std::make_shared<SceneModel::Simulation>(scene_);
 	view_ = std::make_shared<MyView>();
     view_->setScene(scene_);
+	view_->setSimulation(simulation_);
+
+	view_->setTextureArrays(hasOption("--texture-arrays"));
+	view_->setBindlessTextures(!hasOption("--no-bindless"));
+	view_->setLightLists(hasOption("--light-lists"));
+	view_->setGpuAnimation(hasOption("--gpu-animation"));
+	threaded_simulation_ = !hasOption("--no-sim-thread");
+	render_thread_ = hasOption("--render-thread");
+	upload_thread_ = hasOption("--upload-thread");
+	const std::string frames_in_flight = optionValue("--frames-in-flight");
+	if (!frames_in_flight.empty()){
+		view_->setFramesInFlight(std::atoi(frames_in_flight.c_str()));
+	}
+
+	record_path_ = optionValue("--record");
+	const std::string replay_path = optionValue("--replay");
+	if (!replay_path.empty()){
+		if (!loadInputRecording(replay_path, replay_input_)){
+			throw std::runtime_error("Failed to read " + replay_path);
+		}
+		replaying_ = true;
+		benchmark_ = true;
+	}
+	const std::string benchmark = optionValue("--benchmark");
+	if (!benchmark.empty()){
+		//the named camera paths, each driven by scene time alone
+		if (benchmark == "flythrough"){
+			scene_->setCameraAnimation(true);
+			benchmark_ = true;
+		}
+		else if (benchmark == "jobs"){
+			//needs no frames at all
+			runJobBenchmark();
+			close_at_start_ = true;
+		}
+		else {
+			throw std::runtime_error("Unknown benchmark " + benchmark);
+		}
+	}
+	const std::string frames = optionValue("--frames");
+	if (!frames.empty()){
+		benchmark_frames_ = std::max(std::atoi(frames.c_str()), 1);
+	}
+	//a benchmark measures the frames, not the display, unless asked to
+	const std::string pacing = optionValue("--pacing");
+	pacing_ = benchmark_ ? tygra::FrameScheduler::kUncapped
+						 : tygra::FrameScheduler::kAdaptiveVsync;
+	if (pacing == "vsync"){
+		pacing_ = tygra::FrameScheduler::kAdaptiveVsync;
+	}
+	else if (pacing == "fixed"){
+		pacing_ = tygra::FrameScheduler::kFixedRate;
+	}
+	else if (pacing == "uncapped"){
+		pacing_ = tygra::FrameScheduler::kUncapped;
+	}
+	else if (pacing == "on-demand"){
+		pacing_ = tygra::FrameScheduler::kOnDemand;
+	}
+	else if (!pacing.empty()){
+		throw std::runtime_error("Unknown pacing " + pacing);
+	}
+	const std::string fps = optionValue("--fps");
+	target_rate_ = fps.empty() ? 60 : std::max(std::atof(fps.c_str()), 1.0);
+	//on demand there may be no frames for a long while, the scene has to
+	//keep moving without them
+	if (pacing_ == tygra::FrameScheduler::kOnDemand){
+		threaded_simulation_ = true;
+	}
+	//a benchmark has to step on the render thread to follow its clock
+	if (benchmark_){
+		threaded_simulation_ = false;
+		simulation_->setVirtualClock(true);
+	}
 }
 
 MyController::
@@ -23,26 +181,94 @@ MyController::
 {
 }
 
+bool MyController::
+wantsRenderThread() const
+{
+	return render_thread_;
+}
+
+bool MyController::
+wantsUploadThread() const
+{
+	return upload_thread_;
+}
+
 void MyController::
 windowControlWillStart(std::shared_ptr<tygra::Window> window)
 {
     window->setView(view_);
     window->setTitle("3D Graphics Programming :: SpiceMySponza");
+	window->frameScheduler().setMode(pacing_);
+	window->frameScheduler().setTargetRate(target_rate_);
+	if (pacing_ == tygra::FrameScheduler::kOnDemand) {
+		//input wakes the window by itself, the scene has to ask, for the
+		//step that changed it and one more so the blend settles on it
+		tygra::Window* raw_window = window.get();
+		unsigned int seen_version = 0;
+		int frames_owed = 0;
+		simulation_->setPublishCallback([=](const SceneModel::Snapshot& snapshot) mutable {
+			if (snapshot.scene_version != seen_version) {
+				seen_version = snapshot.scene_version;
+				frames_owed = 2;
+			}
+			if (frames_owed > 0) {
+				frames_owed--;
+				raw_window->requestFrame();
+			}
+		});
+	}
+	if (replaying_) {
+		//the events go in as the steps they were recorded on begin, the
+		//commands their handlers post then run in those same steps
+		std::weak_ptr<tygra::Window> weak_window = window;
+		simulation_->setStepCallback([this, weak_window](unsigned int step) {
+			if (auto window = weak_window.lock()) {
+				replayInput(window, step);
+			}
+		});
+	}
+	if (close_at_start_) {
+		window->requestClose();
+	}
 }
 
 void MyController::
 windowControlDidStop(std::shared_ptr<tygra::Window> window)
 {
+	simulation_->stop();
     window->setView(nullptr);
+
+	if (benchmark_ && frame_count_ <= benchmark_frames_){
+		std::cout << "Benchmark stopped early: ";
+		frame_times_.report(std::cout);
+	}
+	if (!record_path_.empty()
+		&& !saveInputRecording(record_path_, recorded_input_)){
+		std::cerr << "Failed to write " << record_path_ << std::endl;
+	}
 }
 
 void MyController::
 windowControlViewWillRender(std::shared_ptr<tygra::Window> window)
 {
-    scene_->update();
-    if (camera_turn_mode_) {
-        scene_->getCamera().setRotationalVelocity(glm::vec2(0, 0));
-    }
+	//nothing moves or is measured until the view has loaded, so loading
+	//stays out of a benchmark and a recording and its replay count their
+	//steps from the same point
+	if (view_->hasLoaded()) {
+		if (benchmark_) {
+			endBenchmarkFrame(window);
+			simulation_->advanceClock(kBenchmarkFrameInterval);
+			//the clock only moves with the frames, so on demand they never stop
+			window->requestFrame();
+		}
+		if (threaded_simulation_ && !simulation_->isRunning()) {
+			simulation_->start();
+		}
+		//without its own thread the simulation catches up here instead
+		if (!simulation_->isRunning()) {
+			simulation_->advance();
+		}
+	}
 }
 
 void MyController::
@@ -50,14 +276,20 @@ windowControlMouseMoved(std::shared_ptr<tygra::Window> window,
                         int x,
                         int y)
 {
+	if (!acceptInput(InputEvent::kMouseMoved, x, (float)y))
+		return;
     static int prev_x = x;
     static int prev_y = y;
     if (camera_turn_mode_) {
         int dx = x - prev_x;
         int dy = y - prev_y;
         const float mouse_speed = 0.6f;
-        scene_->getCamera().setRotationalVelocity(
-            glm::vec2(-dx * mouse_speed, -dy * mouse_speed));
+        //turns for the next step only, so it lasts the same number of steps
+        //however often frames come
+        const glm::vec2 spin(-dx * mouse_speed, -dy * mouse_speed);
+        simulation_->post([spin](SceneModel::Context& scene) {
+            scene.spinCamera(spin);
+        });
     }
     prev_x = x;
     prev_y = y;
@@ -68,6 +300,8 @@ windowControlMouseButtonChanged(std::shared_ptr<tygra::Window> window,
                                 int button_index,
                                 bool down)
 {
+	if (!acceptInput(InputEvent::kMouseButton, button_index, down))
+		return;
     if (button_index == tygra::kWindowMouseButtonLeft) {
         camera_turn_mode_ = down;
     }
@@ -78,6 +312,7 @@ void MyController::
 windowControlMouseWheelMoved(std::shared_ptr<tygra::Window> window,
                              int position)
 {
+	acceptInput(InputEvent::kMouseWheel, position, 0);
 }
 
 void MyController::
@@ -85,6 +320,8 @@ windowControlKeyboardChanged(std::shared_ptr<tygra::Window> window,
                              int key_index,
                              bool down)
 {
+	if (!acceptInput(InputEvent::kKeyboard, key_index, down))
+		return;
 	switch (key_index) {
 	case tygra::kWindowKeyLeft:
 	case 'A':
@@ -113,11 +350,35 @@ windowControlKeyboardChanged(std::shared_ptr<tygra::Window> window,
 	{
 	case tygra::kWindowKeyF1:
 	case 'F1':
-		if (view_->getToggleNormal() == false)
-			view_->setNormalToggle(true);
-		else{
-			view_->setNormalToggle(false);
-		}
+		//the view is only ever touched from the thread that renders it
+		window->runOnRenderThread([this]{
+			if (view_->getToggleNormal() == false)
+				view_->setNormalToggle(true);
+			else{
+				view_->setNormalToggle(false);
+			}
+		});
+		break;
+	case tygra::kWindowKeyF2:
+		window->runOnRenderThread([this]{
+			//print how the texture streamer is doing against its budget
+			const auto stats = view_->getTextureStats();
+			std::cout << "Textures: " << stats.resident_bytes / 1024 << "KB of "
+				<< stats.budget_bytes / 1024 << "KB resident, "
+				<< stats.pending_requests << " pending, "
+				<< stats.budget_overruns << " budget overruns, "
+				<< stats.evictions << " evictions" << std::endl;
+			std::cout << "Scene uploads: " << view_->getFrameUploadBytes()
+				<< " bytes last frame" << std::endl;
+			std::cout << "Frame pipeline: ";
+			reportFrameStats(std::cout, view_->getFrameStats());
+			view_->resetFrameStats();
+		});
+		//the scheduler belongs to this thread, not the render thread
+		std::cout << "Frame pacing: ";
+		reportPacingStats(std::cout, window->frameScheduler().getStats());
+		window->frameScheduler().resetStats();
+		break;
 	}
 }
 
@@ -127,6 +388,9 @@ windowControlGamepadAxisMoved(std::shared_ptr<tygra::Window> window,
                               int axis_index,
                               float pos)
 {
+	if (!acceptInput(InputEvent::kGamepadAxis,
+					 gamepad_index * 256 + axis_index, pos))
+		return;
 	const float deadzone = 0.2f;
 	const float rotate_speed = 3.f;
 	switch (axis_index) {
@@ -165,7 +429,7 @@ windowControlGamepadAxisMoved(std::shared_ptr<tygra::Window> window,
 		else {
 			camera_rotate_speed_[0] = 0.f;
 		}
-        scene_->getCamera().setRotationalVelocity(
+        setCameraRotationalVelocity(
             glm::vec2(camera_rotate_speed_[0] * rotate_speed,
 			          camera_rotate_speed_[1] * rotate_speed));
 		break;
@@ -176,7 +440,7 @@ windowControlGamepadAxisMoved(std::shared_ptr<tygra::Window> window,
 		else {
 			camera_rotate_speed_[1] = 0.f;
 		}
-        scene_->getCamera().setRotationalVelocity(
+        setCameraRotationalVelocity(
             glm::vec2(camera_rotate_speed_[0] * rotate_speed,
 			          camera_rotate_speed_[1] * rotate_speed));
 		break;
@@ -191,6 +455,86 @@ windowControlGamepadButtonChanged(std::shared_ptr<tygra::Window> window,
                                   int button_index,
                                   bool down)
 {
+	acceptInput(InputEvent::kGamepadButton,
+				gamepad_index * 256 + button_index, down);
+}
+
+bool MyController::
+acceptInput(InputEvent::Kind kind, int index, float value)
+{
+	if (replaying_ && !dispatching_replay_) {
+		return false;
+	}
+	if (!record_path_.empty()) {
+		//stamped when the simulation runs it, on the same step as the
+		//commands the handler is about to post
+		simulation_->post([this, kind, index, value](SceneModel::Context&) {
+			const InputEvent event = { simulation_->getStepCount(),
+									   kind, index, value };
+			recorded_input_.push_back(event);
+		});
+	}
+	return true;
+}
+
+void MyController::
+replayInput(std::shared_ptr<tygra::Window> window, unsigned int step)
+{
+	dispatching_replay_ = true;
+	while (next_replay_event_ < replay_input_.size()
+		&& replay_input_[next_replay_event_].step <= step) {
+		const InputEvent& event = replay_input_[next_replay_event_++];
+		const bool down = event.value != 0;
+		switch (event.kind) {
+		case InputEvent::kMouseMoved:
+			windowControlMouseMoved(window, event.index, (int)event.value);
+			break;
+		case InputEvent::kMouseButton:
+			windowControlMouseButtonChanged(window, event.index, down);
+			break;
+		case InputEvent::kMouseWheel:
+			windowControlMouseWheelMoved(window, event.index);
+			break;
+		case InputEvent::kKeyboard:
+			windowControlKeyboardChanged(window, event.index, down);
+			break;
+		case InputEvent::kGamepadAxis:
+			windowControlGamepadAxisMoved(window, event.index / 256,
+										  event.index % 256, event.value);
+			break;
+		case InputEvent::kGamepadButton:
+			windowControlGamepadButtonChanged(window, event.index / 256,
+											  event.index % 256, down);
+			break;
+		}
+	}
+	dispatching_replay_ = false;
+}
+
+void MyController::
+endBenchmarkFrame(std::shared_ptr<tygra::Window> window)
+{
+	const double now = tygra::FrameScheduler::now();
+	//the first frame has no start to be timed from
+	if (frame_count_ > 0) {
+		frame_times_.add(now - frame_start_);
+	}
+	else {
+		SceneModel::JobSystem::shared().resetStats();
+		window->runOnRenderThread([this]{ view_->resetFrameStats(); });
+	}
+	frame_start_ = now;
+	if (frame_count_++ == benchmark_frames_) {
+		std::cout << "Benchmark: ";
+		frame_times_.report(std::cout);
+		std::cout << "Job system: ";
+		reportJobStats(std::cout, SceneModel::JobSystem::shared().getStats());
+		window->runOnRenderThread([this]{
+			std::cout << "Frame pipeline: ";
+			reportFrameStats(std::cout, view_->getFrameStats());
+		}, true);
+		window->requestClose();
+	}
 }
 
 void MyController::
@@ -201,6 +545,17 @@ updateCameraTranslation()
 		+ key_speed * camera_move_speed_[1];
 	const float forward_speed = key_speed * camera_move_speed_[2]
 		- key_speed * camera_move_speed_[3];
-    scene_->getCamera().setLinearVelocity(
-        glm::vec3(sideward_speed, 0, forward_speed));
+	const glm::vec3 velocity(sideward_speed, 0, forward_speed);
+	simulation_->post([velocity](SceneModel::Context& scene) {
+		scene.getCamera().setLinearVelocity(velocity);
+	});
+}
+
+void MyController::
+setCameraRotationalVelocity(glm::vec2 velocity)
+{
+	//the scene belongs to the simulation, changes go through it
+	simulation_->post([velocity](SceneModel::Context& scene) {
+		scene.getCamera().setRotationalVelocity(velocity);
+	});
 }
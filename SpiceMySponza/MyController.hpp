@@ -1,6 +1,13 @@
 #pragma once
 #include <tygra/WindowControlDelegate.hpp>
+#include <tygra/FrameScheduler.hpp>
 #include <SceneModel/SceneModel_fwd.hpp>
+#include "FrameTimes.hpp"
+#include "InputRecording.hpp"
+#include <glm/glm.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
 
 class MyView;
 
@@ -8,10 +15,59 @@ class MyController : public tygra::WindowControlDelegate
 {
 public:
     
-    MyController();
+    /**
+     Command line options:
+       --texture-arrays  pack textures into GL_TEXTURE_2D_ARRAYs
+       --no-bindless     never use ARB_bindless_texture handles
+       --light-lists     light each instance with its brightest few lights
+       --gpu-animation   move the animated instances and lights in the
+                         shaders instead of sending them every frame
+       --no-sim-thread   step the scene on the main thread
+       --render-thread   render on a thread of its own, fed frames by the
+                         main thread through a short queue, main.cpp asks
+                         wantsRenderThread() before opening the window
+       --upload-thread   create buffers and textures on a thread with a
+                         shared GL context, see wantsUploadThread()
+       --frames-in-flight N  let the CPU run up to N frames ahead of the
+                         GPU, 1 to 4, 2 by default
+       --pacing MODE     when frames are drawn: "vsync" (adaptive, the
+                         default), "fixed" at the --fps rate, "uncapped"
+                         (the default for benchmarks) or "on-demand", only
+                         on input, when the scene changes or while loading
+                         and streaming, with the scene stepped on its own
+                         thread whatever --no-sim-thread says
+       --fps N           target rate of fixed pacing, 60 by default
+       --grid CxR        tile the scene on a C by R grid, or CxC from just C
+       --unique-meshes   give every tile its own copy of the meshes
+       --lights K        scatter K extra point lights over the grid
+       --materials M     use M materials, the extras tinted copies
+       --record FILE     save the input to FILE when the window closes
+       --replay FILE     play back the input saved in FILE, ignoring live
+                         input, as a benchmark run
+       --benchmark NAME  run the named camera path as a benchmark, only
+                         "flythrough" so far, or "jobs" to time the job
+                         system against serial loops and close
+       --frames N        frames in a benchmark run, 1000 by default
+
+     The scene only starts stepping once the view has loaded. A benchmark
+     run then steps the simulation on a virtual clock that moves a fixed
+     interval each frame, so every run draws exactly the same frames and
+     none of the loading ones are counted.
+     It prints the frame time percentiles and closes the window at the end.
+     F2 and the end of a benchmark also print how long the CPU waited on
+     frame fences against how long the GPU sat idle between frames, F2 also
+     the frame time variance since it was last pressed.
+     */
+    MyController(const std::vector<std::string>& options);
 
     ~MyController();
 
+    bool
+    wantsRenderThread() const;
+
+    bool
+    wantsUploadThread() const;
+
 private:
 
     void
@@ -54,13 +110,53 @@ private:
                                       int button_index,
                                       bool down) override;
 
+    //records the event when recording, false for live input while
+    //replaying so the handler ignores it
+    bool
+    acceptInput(InputEvent::Kind kind, int index, float value);
+
+    //feed the recorded events due by the given step through the handlers,
+    //called by the simulation at the start of every step
+    void
+    replayInput(std::shared_ptr<tygra::Window> window, unsigned int step);
+
+    void
+    endBenchmarkFrame(std::shared_ptr<tygra::Window> window);
+
     void
     updateCameraTranslation();
 
+    void
+    setCameraRotationalVelocity(glm::vec2 velocity);
+
     std::shared_ptr<MyView> view_;
     std::shared_ptr<SceneModel::Context> scene_;
+    std::shared_ptr<SceneModel::Simulation> simulation_;
+    bool threaded_simulation_;
 
     bool camera_turn_mode_;
 	float camera_move_speed_[4];
 	float camera_rotate_speed_[2];
+
+	std::string record_path_;
+	//filled by the simulation's commands, read once it has stopped
+	std::vector<InputEvent> recorded_input_;
+	std::vector<InputEvent> replay_input_;
+	size_t next_replay_event_;
+	bool replaying_;
+	bool dispatching_replay_;
+
+	bool render_thread_;
+	bool upload_thread_;
+
+	tygra::FrameScheduler::Mode pacing_;
+	double target_rate_;
+
+	bool benchmark_;
+	int benchmark_frames_;
+	bool close_at_start_;
+	int frame_count_;
+	FrameTimes frame_times_;
+	//on tygra::FrameScheduler::now()'s clock
+	double frame_start_;
 };
@@ -1,13 +1,24 @@
 #include "MyView.hpp"
 #include <SceneModel/SceneModel.hpp>
 #include <tygra/FileHelper.hpp>
+#include <tygra/AsyncLoader.hpp>
+#include <tygra/Window.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <cstring>
 #include <unordered_map>
+#include <string>
 
-MyView::MyView()
+//GL work done per frame while loading, the rest of the frame shows progress
+static const double kLoadingSliceSeconds = 0.008;
+
+//instances per job when culling and ranking lights
+static const size_t kCullGrain = 256;
+
+MyView::MyView() : loaded_(false), texture_budget_(256 * 1024 * 1024)
 {
 }
 
@@ -19,6 +30,11 @@ void MyView::setScene(std::shared_ptr<const SceneModel::Context> scene)
 	scene_ = scene;
 }
 
+void MyView::setSimulation(std::shared_ptr<SceneModel::Simulation> simulation)
+{
+	simulation_ = simulation;
+}
+
 //When toggled it will shade the scene using the normals value
 //so you can check to see if the scene has been drawn correctly
 //with out any (BAD)lighting that may obscure your view 
@@ -31,15 +47,365 @@ void MyView::setNormalToggle(bool value){
 	glUniform1i(toggle_id, normal_toggle);
 }
 
+void MyView::setTextureBudget(size_t bytes)
+{
+	texture_budget_ = bytes;
+	if (texture_streamer_ != nullptr){
+		texture_streamer_->setBudget(bytes);
+	}
+}
+
+TextureStreamer::Stats MyView::getTextureStats() const
+{
+	if (texture_streamer_ == nullptr){
+		//nothing is streamed when texture arrays or bindless handles are in use
+		TextureStreamer::Stats stats = { 0, texture_budget_, 0, 0, 0 };
+		return stats;
+	}
+	return texture_streamer_->getStats();
+}
+
+void MyView::setTextureArrays(bool value)
+{
+	//only takes effect when the view next starts
+	useTextureArrays_ = value;
+}
+
+void MyView::setBindlessTextures(bool allowed)
+{
+	//only takes effect when the view next starts
+	allowBindless_ = allowed;
+}
+
+void MyView::setLightLists(bool value)
+{
+	//only takes effect when the view next starts
+	useLightLists_ = value;
+}
+
+void MyView::setGpuAnimation(bool value)
+{
+	//only takes effect when the view next starts
+	useGpuAnimation_ = value;
+}
+
 void MyView::windowViewWillStart(std::shared_ptr<tygra::Window> window)
 {
 	assert(scene_ != nullptr);
 
+	//prefer bindless handles unless texture arrays were asked for, otherwise
+	//fall back to binding streamed textures
+	useBindless_ = allowBindless_ && !useTextureArrays_
+		&& tglIsAvailable(TGL_EXTENSION_ARB_BINDLESS_TEXTURE) == GL_TRUE;
+
+	/*
+	###################################
+	Nothing is loaded here directly, instead every asset becomes a task for the
+	loader. File reads, mesh building and image decoding run on worker threads
+	all at the same time and only the GL calls that follow them run on this
+	thread, a few each frame from windowViewRender which draws a progress bar
+	until the last task is done. Tasks list the tasks they need first, e.g. the
+	shader program needs both sources read.
+	###################################
+	*/
+
+	assert(simulation_ != nullptr);
+	frame_transforms_ = simulation_->getInitialTransforms();
+
+	//every transform is sent once here to every frame's copy, after that only
+	//the ones that move
+	frame_pipeline_.reset(new FramePipeline(frames_in_flight_));
+	const int frame_slots = frame_pipeline_->framesInFlight();
+	instance_tbos_.resize(frame_slots);
+	instance_tbo_textures_.resize(frame_slots);
+	glGenBuffers(frame_slots, instance_tbos_.data());
+	glGenTextures(frame_slots, instance_tbo_textures_.data());
+	for (int i = 0; i < frame_slots; i++){
+		glBindBuffer(GL_TEXTURE_BUFFER, instance_tbos_[i]);
+		glBufferData(GL_TEXTURE_BUFFER,
+			frame_transforms_.size() * sizeof(glm::mat4x3),
+			frame_transforms_.data(),
+			GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_BUFFER, instance_tbo_textures_[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instance_tbos_[i]);
+	}
+	recent_instance_ranges_.clear();
+
+	//motions are part of the static scene, sent once for the whole run
+	gpu_animated_.assign(frame_transforms_.size(), 0);
+	if (useGpuAnimation_){
+		const SceneModel::AnalyticMotion* motions = scene_->getInstanceMotionArray();
+		std::vector<glm::vec4> motion_texels(frame_transforms_.size() * kMotionTexels);
+		for (size_t i = 0; i < frame_transforms_.size(); i++){
+			const auto& motion = motions[i];
+			gpu_animated_[i] = motion.animated;
+			motion_texels[i * kMotionTexels] = glm::vec4(motion.centre, motion.frequency);
+			motion_texels[i * kMotionTexels + 1] = glm::vec4(motion.cosine_axis, motion.phase);
+			motion_texels[i * kMotionTexels + 2] = glm::vec4(motion.sine_axis, motion.animated ? 1.f : 0.f);
+		}
+		glGenBuffers(1, &motion_tbo_);
+		glBindBuffer(GL_TEXTURE_BUFFER, motion_tbo_);
+		glBufferData(GL_TEXTURE_BUFFER,
+			motion_texels.size() * sizeof(glm::vec4),
+			motion_texels.data(),
+			GL_STATIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		glGenTextures(1, &motion_tbo_texture_);
+		glBindTexture(GL_TEXTURE_BUFFER, motion_tbo_texture_);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, motion_tbo_);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	//materials are sent by the first frame, from version zero
+	glGenBuffers(1, &material_tbo_);
+	glGenTextures(1, &material_tbo_texture_);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	material_version_ = 0;
+	material_params_.clear();
+
+	//the new program has none of the lights yet
+	light_generation_ = 0;
+	light_positions_.assign(kMaxLights, glm::vec3(0));
+	light_intensities_.assign(kMaxLights, glm::vec3(0));
+	light_ranges_.assign(kMaxLights, 0.f);
+	light_motions_.assign(kMaxLights, SceneModel::AnalyticMotion());
+	light_index_.clear();
+
+	//the worker tasks share the job system with everything else
+	typedef tygra::AsyncLoader Loader;
+	loader_.reset(new Loader([this](std::function<void()> task){
+		SceneModel::JobSystem::shared().run(loader_jobs_, std::move(task));
+	}));
+	load_start_ = std::chrono::steady_clock::now();
+	loaded_ = false;
+
 	//load shaders from text file, compile errors can be viewed via the info log.
+	auto vertex_shader_string = std::make_shared<std::string>();
+	auto fragment_shader_string = std::make_shared<std::string>();
+
+	const Loader::TaskId read_vertex_shader = loader_->addTask(Loader::kWorkerThread,
+		[this, vertex_shader_string]{
+		*vertex_shader_string = tygra::stringFromFile("sponza_vs.glsl");
+		if (useGpuAnimation_){
+			//move the animated instances by their motions
+			vertex_shader_string->insert(vertex_shader_string->find('\n') + 1,
+				"#define USE_ANALYTIC_MOTION\n");
+		}
+	});
+
+	const Loader::TaskId read_fragment_shader = loader_->addTask(Loader::kWorkerThread,
+		[this, fragment_shader_string]{
+		*fragment_shader_string = tygra::stringFromFile("sponza_fs.glsl");
+		if (useTextureArrays_){
+			//switch the samplers to sampler2DArray, defines must follow #version
+			fragment_shader_string->insert(fragment_shader_string->find('\n') + 1,
+				"#define USE_TEXTURE_ARRAYS\n");
+		}
+		else if (useBindless_){
+			//sample through handles from the MaterialTextures block instead
+			fragment_shader_string->insert(fragment_shader_string->find('\n') + 1,
+				"#define USE_BINDLESS_TEXTURES\n");
+		}
+		if (useLightLists_){
+			//loop over the instance's own light list instead of every light
+			fragment_shader_string->insert(fragment_shader_string->find('\n') + 1,
+				"#define USE_LIGHT_LISTS\n#define MAX_INSTANCE_LIGHTS "
+				+ std::to_string(kMaxInstanceLights) + "\n");
+		}
+		if (useGpuAnimation_){
+			//and the animated lights by theirs
+			fragment_shader_string->insert(fragment_shader_string->find('\n') + 1,
+				"#define USE_ANALYTIC_MOTION\n");
+		}
+	});
+
+	const Loader::TaskId link_program = loader_->addTask(Loader::kMainThread,
+		[this, vertex_shader_string, fragment_shader_string]{
+		createShaderProgram(*vertex_shader_string, *fragment_shader_string);
+	}, { read_vertex_shader, read_fragment_shader });
+
+	/*
+	##################################
+	The GeometryBuilder reads the whole scene file and the bounds of every mesh
+	are measured on the same worker, then each mesh gets its own GL task so the
+	buffer uploads are spread across frames
+	##################################
+	*/
+
+	Loader* loader = loader_.get();
+	tygra::Window* uploader = window.get();
+	uploads_live_ = std::make_shared<bool>(true);
+	const SceneModel::SceneDescription description = scene_->getDescription();
+	loader_->addTask(Loader::kWorkerThread, [this, loader, uploader, description]{
+		//get all of the sponza meshes from the GeometryBuilder, built from the
+		//same description as the scene so the mesh ids match
+		auto builder = std::make_shared<SceneModel::GeometryBuilder>(description);
+		for (const auto& scene_mesh : builder->getAllMeshes()){
+			MeshGL measured;
+			measureMesh(scene_mesh, measured);
+
+			const SceneModel::Mesh* source_mesh = &scene_mesh;
+			loader->addTask(Loader::kMainThread,
+				[this, uploader, builder, source_mesh, measured]{
+				//mesh tables are indexed by the slot of the mesh's handle
+				const size_t slot = SceneModel::HandleTable::slot(source_mesh->getId());
+				if (slot >= sponza_mesh_.size()){
+					sponza_mesh_.resize(slot + 1);
+				}
+				sponza_mesh_[slot] = measured;
+
+				//the buffers fill on the upload thread, the builder keeps the
+				//source mesh alive until they have
+				auto uploaded = std::make_shared<MeshGL>(measured);
+				auto live = uploads_live_;
+				pending_mesh_uploads_++;
+				uploader->upload([builder, source_mesh, uploaded]{
+					uploadMesh(*source_mesh, *uploaded);
+				}, [this, slot, uploaded, live]{
+					if (!*live){
+						glDeleteBuffers(1, &uploaded->positions_vbo);
+						glDeleteBuffers(1, &uploaded->normals_vbo);
+						glDeleteBuffers(1, &uploaded->texcoords_vbo);
+						glDeleteBuffers(1, &uploaded->element_vbo);
+						return;
+					}
+					MeshGL& newMesh = sponza_mesh_[slot];
+					newMesh = *uploaded;
+					createVertexArray(newMesh);
+					pending_mesh_uploads_--;
+				});
+			});
+		}
+	});
+
+	/*
+	###################################
+	There are 4 textures for this scene seperated into two categories Diffuse and Specular
+		The textures are handed to a texture streamer which loads the small mips
+		in the background straight away and the bigger mips only when an instance
+		using them is close enough to need them. A Hash Map/un_ordered map holds
+		the string value (filename) of each texture and its index in the streamer.
+
+	The hash map will be used in the render method, as I'll Check every instance for a diffuse or specular
+	texture, if one is found I'll then create a texture sampler and send it to the shader and handle it from 
+	there.
+	###################################
+	*/
+
+	//extract the materials form the scene
+	const auto& sponza_materials = scene_->getAllMaterials();
+
+	//optionally pack all of the textures into arrays instead, these are
+	//fully resident and never streamed
+	if (useTextureArrays_){
+		//the units from kMotionUnit up hold the scene's texture buffers
+		texture_arrays_.setUnitLimit(kMotionUnit);
+		for (const auto& material : sponza_materials){
+			if (material.getDiffuseTexture() != ""){
+				texture_arrays_.addTexture(material.getDiffuseTexture());
+			}
+			if (material.getSpecularTexture() != ""){
+				texture_arrays_.addTexture(material.getSpecularTexture());
+			}
+		}
+
+		//every file decodes on its own worker, the arrays need all of them
+		std::vector<Loader::TaskId> decodes;
+		for (int i = 0; i < texture_arrays_.textureCount(); i++){
+			decodes.push_back(loader_->addTask(Loader::kWorkerThread,
+				[this, i]{ texture_arrays_.decodeTexture(i); }));
+		}
+		loader_->addTask(Loader::kMainThread,
+			[this]{ texture_arrays_.upload(); }, decodes);
+	}
+	else if (useBindless_){
+		for (const auto& material : sponza_materials){
+			if (SceneModel::HandleTable::slot(material.getId()) >= kMaxMaterials){
+				continue;
+			}
+			if (material.getDiffuseTexture() != ""){
+				bindless_textures_.addTexture(material.getDiffuseTexture());
+			}
+			if (material.getSpecularTexture() != ""){
+				bindless_textures_.addTexture(material.getSpecularTexture());
+			}
+		}
+
+		std::vector<Loader::TaskId> decodes;
+		for (int i = 0; i < bindless_textures_.textureCount(); i++){
+			decodes.push_back(loader_->addTask(Loader::kWorkerThread,
+				[this, i]{ bindless_textures_.decodeTexture(i); }));
+		}
+		const Loader::TaskId upload_textures = loader_->addTask(Loader::kMainThread,
+			[this]{ bindless_textures_.upload(); }, decodes);
+
+		//once every handle exists, write both handles of each material into
+		//the buffer the shader reads them from
+		loader_->addTask(Loader::kMainThread, [this]{
+			const auto& sponza_materials = scene_->getAllMaterials();
+			std::vector<GLuint64> material_handles(kMaxMaterials * 2, 0);
+			//each material's handles sit at its slot, so the shader indexes the
+			//buffer the same way the scene's handle table does
+			for (const auto& material : sponza_materials){
+				const size_t slot = SceneModel::HandleTable::slot(material.getId());
+				if (slot >= kMaxMaterials){
+					continue;
+				}
+				material_handles[slot * 2] = bindless_textures_.handle(material.getDiffuseTexture());
+				material_handles[slot * 2 + 1] = bindless_textures_.handle(material.getSpecularTexture());
+			}
+
+			glGenBuffers(1, &material_ubo_);
+			glBindBuffer(GL_UNIFORM_BUFFER, material_ubo_);
+			glBufferData(GL_UNIFORM_BUFFER,
+				material_handles.size() * sizeof(GLuint64),
+				material_handles.data(),
+				GL_STATIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			glUniformBlockBinding(shader_program_,
+				glGetUniformBlockIndex(shader_program_, "MaterialTextures"), 0);
+		}, { upload_textures, link_program });
+	}
+	else{
+		//the streamer decodes as jobs on the shared job system by itself,
+		//only registering the textures is left
+		loader_->addTask(Loader::kMainThread, [this, uploader]{
+			texture_streamer_.reset(new TextureStreamer(texture_budget_));
+			texture_streamer_->setUploader([uploader](std::function<void()> work,
+				std::function<void()> ready){
+				uploader->upload(work, ready);
+			});
+
+			//loop through all the materials
+			for (const auto& material : scene_->getAllMaterials()){
+
+				const std::string texture_strings[] = { material.getDiffuseTexture(),
+														material.getSpecularTexture() };
+
+				for (const auto& texture_string : texture_strings){
+
+					//check to see if the string is NOT empty and not already loaded,
+					//when it isnt that means a texture can be created and stored
+					if (texture_string != "" && textures_.find(texture_string) == textures_.end()){
+
+						//add the string along with the streamer index to the hash map
+						textures_.insert({ texture_string, texture_streamer_->addTexture(texture_string) });
+					}
+				}
+			}
+		});
+	}
+
+}
+
+void MyView::createShaderProgram(const std::string& vertex_shader_string,
+	const std::string& fragment_shader_string)
+{
 	GLint compile_status = 0;
 
 	GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-	std::string vertex_shader_string = tygra::stringFromFile("sponza_vs.glsl");
 	const char *vertex_shader_code = vertex_shader_string.c_str();
 	glShaderSource(vertex_shader, 1,
 		(const GLchar **)&vertex_shader_code, NULL);
@@ -53,7 +419,6 @@ void MyView::windowViewWillStart(std::shared_ptr<tygra::Window> window)
 	}
 
 	GLuint fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-	std::string fragment_shader_string = tygra::stringFromFile("sponza_fs.glsl");
 	const char *fragment_shader_code = fragment_shader_string.c_str();
 	glShaderSource(fragment_shader, 1,
 		(const GLchar **)&fragment_shader_code, NULL);
@@ -74,7 +439,7 @@ void MyView::windowViewWillStart(std::shared_ptr<tygra::Window> window)
 	glBindAttribLocation(shader_program_, 2, "texture_coord");
 	glDeleteShader(vertex_shader);
 	glAttachShader(shader_program_, fragment_shader);
-	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
 	glLinkProgram(shader_program_);
 
 	//test if the program linked successfully
@@ -87,200 +452,705 @@ void MyView::windowViewWillStart(std::shared_ptr<tygra::Window> window)
 		std::cerr << log << std::endl;
 	}
 
+	//the texture buffers always sit on the same units
+	glUseProgram(shader_program_);
+	glUniform1i(glGetUniformLocation(shader_program_, "instance_xforms"), kInstanceUnit);
+	glUniform1i(glGetUniformLocation(shader_program_, "material_params"), kMaterialUnit);
+	glUniform1i(glGetUniformLocation(shader_program_, "instance_motions"), kMotionUnit);
+
+	//and the streamed textures on the first two
+	if (!useTextureArrays_ && !useBindless_){
+		glUniform1i(glGetUniformLocation(shader_program_, "diff_tex_sample"), 0);
+		glUniform1i(glGetUniformLocation(shader_program_, "spec_tex_sample"), 1);
+	}
 
-	//get all of the sponza meshes from the GeometryBuilder
-	SceneModel::GeometryBuilder builder;
-	const auto& source_meshes = builder.getAllMeshes();
+	//the uniforms every draw sets, looked up once
+	draw_uniforms_.instance_index = glGetUniformLocation(shader_program_, "instance_index");
+	draw_uniforms_.material_index = glGetUniformLocation(shader_program_, "material_index");
+	draw_uniforms_.diff_tex_sample = glGetUniformLocation(shader_program_, "diff_tex_sample");
+	draw_uniforms_.diff_tex_layer = glGetUniformLocation(shader_program_, "diff_tex_layer");
+	draw_uniforms_.spec_tex_sample = glGetUniformLocation(shader_program_, "spec_tex_sample");
+	draw_uniforms_.spec_tex_layer = glGetUniformLocation(shader_program_, "spec_tex_layer");
+	draw_uniforms_.use_diff_texture = glGetUniformLocation(shader_program_, "useDiffTexture");
+	draw_uniforms_.use_spec_texture = glGetUniformLocation(shader_program_, "useSpecTexture");
+	draw_uniforms_.instance_lights = glGetUniformLocation(shader_program_, "Instance_Lights");
+	draw_uniforms_.instance_light_count = glGetUniformLocation(shader_program_, "Instance_Light_Count");
+}
 
-	/*
-	##################################
-	loop through every mesh getting its position, normal texcoord and element
-	data, then fill the OPENGL buffers with the givin data, this is an efficient use 
-	of the openGL API as all the buffers for the ENTIRE scene get created in one loop,
-	to make it even more efficient an interleaved buffer should be used(however i've not got that working yet)
-	##################################
-	*/
+void MyView::measureMesh(const SceneModel::Mesh& scene_mesh, MeshGL& newMesh)
+{
+	const auto& positions = scene_mesh.getPositionArray();
+	const auto& texcoords = scene_mesh.getTextureCoordinateArray();
+
+	//bounding sphere around the centre of the mesh's box
+	glm::vec3 min_position(positions.empty() ? glm::vec3(0) : positions[0]);
+	glm::vec3 max_position(min_position);
+	for (const auto& position : positions){
+		min_position = glm::min(min_position, position);
+		max_position = glm::max(max_position, position);
+	}
+	newMesh.bounds_centre = (min_position + max_position) * 0.5f;
+	newMesh.bounds_radius = glm::length(max_position - min_position) * 0.5f;
+
+	//number of times the texture repeats across the mesh
+	glm::vec2 min_texcoord(texcoords.empty() ? glm::vec2(0) : texcoords[0]);
+	glm::vec2 max_texcoord(min_texcoord);
+	for (const auto& texcoord : texcoords){
+		min_texcoord = glm::min(min_texcoord, texcoord);
+		max_texcoord = glm::max(max_texcoord, texcoord);
+	}
+	const glm::vec2 texcoord_extent = max_texcoord - min_texcoord;
+	newMesh.texcoord_span = glm::max(1.f,
+		glm::max(texcoord_extent.x, texcoord_extent.y));
+}
 
-	for (const auto scene_mesh : source_meshes){
-		MeshGL& newMesh = sponza_mesh_[scene_mesh.getId()];
-
-		//extract the position, normal texcoord and element data
-		const auto& positions = scene_mesh.getPositionArray();
-		const auto& elements = scene_mesh.getElementArray();
-		const auto& normals = scene_mesh.getNormalArray();
-		const auto& texcoords = scene_mesh.getTextureCoordinateArray();
-
-		//fill the 'positions_vbo' with the position data
-		glGenBuffers(1, &newMesh.positions_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.positions_vbo);
-		glBufferData(GL_ARRAY_BUFFER,
-			positions.size() * sizeof(glm::vec3),
-			positions.data(),
-			GL_STATIC_DRAW);
+void MyView::uploadMesh(const SceneModel::Mesh& scene_mesh, MeshGL& newMesh)
+{
+	//extract the position, normal texcoord and element data
+	const auto& positions = scene_mesh.getPositionArray();
+	const auto& elements = scene_mesh.getElementArray();
+	const auto& normals = scene_mesh.getNormalArray();
+	const auto& texcoords = scene_mesh.getTextureCoordinateArray();
+
+	//fill the 'positions_vbo' with the position data
+	glGenBuffers(1, &newMesh.positions_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.positions_vbo);
+	glBufferData(GL_ARRAY_BUFFER,
+		positions.size() * sizeof(glm::vec3),
+		positions.data(),
+		GL_STATIC_DRAW);
+
+	//unbind the active buffer to ensure no potential faults occur 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//fill the 'normals_vbo' with the position data
+	glGenBuffers(1, &newMesh.normals_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.normals_vbo);
+	glBufferData(GL_ARRAY_BUFFER,
+		normals.size() * sizeof(glm::vec3),
+		normals.data(),
+		GL_STATIC_DRAW);
+
+	//unbind the active buffer to ensure no potential faults occur 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//fill the 'texcoords' with the position data
+	glGenBuffers(1, &newMesh.texcoords_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.texcoords_vbo);
+	glBufferData(GL_ARRAY_BUFFER,
+		texcoords.size() * sizeof(glm::vec2),
+		texcoords.data(),
+		GL_STATIC_DRAW);
+
+	//unbind the active buffer to ensure no potential faults occur 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//fill the 'element_vbo' with element data
+	glGenBuffers(1, &newMesh.element_vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newMesh.element_vbo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+		elements.size() * sizeof(unsigned int),
+		elements.data(),
+		GL_STATIC_DRAW);
+
+	//unbind the active buffer to ensure no potential faults occur 
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	//update the element count
+	newMesh.element_count = elements.size();
+}
 
-		//unbind the active buffer to ensure no potential faults occur 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+void MyView::createVertexArray(MeshGL& newMesh)
+{
+	glGenVertexArrays(1, &newMesh.vao);
+	glBindVertexArray(newMesh.vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newMesh.element_vbo);
 
-		//fill the 'normals_vbo' with the position data
-		glGenBuffers(1, &newMesh.normals_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.normals_vbo);
-		glBufferData(GL_ARRAY_BUFFER,
-			normals.size() * sizeof(glm::vec3),
-			normals.data(),
-			GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.positions_vbo);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), TGL_BUFFER_OFFSET(0));
 
-		//unbind the active buffer to ensure no potential faults occur 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.normals_vbo);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), TGL_BUFFER_OFFSET(0));
 
-		//fill the 'texcoords' with the position data
-		glGenBuffers(1, &newMesh.texcoords_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.texcoords_vbo);
-		glBufferData(GL_ARRAY_BUFFER,
-			texcoords.size() * sizeof(glm::vec2),
-			texcoords.data(),
-			GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, newMesh.texcoords_vbo);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), TGL_BUFFER_OFFSET(0));
 
-		//unbind the active buffer to ensure no potential faults occur 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	//unbind the active buffer to ensure no potential faults occur 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
 
-		//fill the 'element_vbo' with element data
-		glGenBuffers(1, &newMesh.element_vbo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newMesh.element_vbo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-			elements.size() * sizeof(unsigned int),
-			elements.data(),
-			GL_STATIC_DRAW);
+void MyView::uploadLightChanges(const SceneModel::Snapshot& previous,
+	const SceneModel::Snapshot& current,
+	float blend)
+{
+	const auto& light_changes = current.light_changes;
+	const auto& sponza_light_ = current.lights;
+	const int light_count = std::min((int)sponza_light_.size(), kMaxLights);
+
+	//copy the changed fields and track the lowest and highest index changed
+	//in each array, only that range of the uniform array gets sent
+	enum { kPosition, kIntensity, kRange, kMotion };
+	int first[4] = { kMaxLights, kMaxLights, kMaxLights, kMaxLights };
+	int last[4] = { -1, -1, -1, -1 };
+	auto touch = [&](int field, int index){
+		first[field] = std::min(first[field], index);
+		last[field] = std::max(last[field], index);
+	};
+
+	//the rest only when the scene says they changed
+	const bool lights_changed = light_changes.generation != light_generation_;
+	light_generation_ = light_changes.generation;
+	for (const auto& change : light_changes.changed){
+		const int i = (int)change.index;
+		if (!lights_changed || i >= light_count){
+			break;
+		}
+		const auto& light = sponza_light_[i];
+		if (change.fields & SceneModel::Context::kLightIntensity){
+			light_intensities_[i] = light.getIntensity();
+			touch(kIntensity, i);
+		}
+		if (change.fields & SceneModel::Context::kLightRange){
+			light_ranges_[i] = light.getRange();
+			touch(kRange, i);
+		}
+		if (useGpuAnimation_ && (change.fields & SceneModel::Context::kLightMotion)){
+			light_motions_[i] = light.getMotion();
+			touch(kMotion, i);
+			//a light that stops being animated needs its position again
+			touch(kPosition, i);
+		}
+	}
+
+	//positions move between every step so blend them every frame, a light
+	//that only exists in the current step jumps straight there, and the
+	//animated ones are never sent but kept for the CPU side at frame_time_
+	for (int i = 0; i < light_count; i++){
+		if (useGpuAnimation_ && light_motions_[i].animated){
+			light_positions_[i] = light_motions_[i].evaluate(frame_time_);
+			continue;
+		}
+		glm::vec3 position = sponza_light_[i].getPosition();
+		if (i < (int)previous.lights.size()
+			&& previous.lights[i].getId() == sponza_light_[i].getId()){
+			position = glm::mix(previous.lights[i].getPosition(), position, blend);
+		}
+		if (position != light_positions_[i]){
+			light_positions_[i] = position;
+			touch(kPosition, i);
+		}
+	}
+
+	//uniform arrays can be written from any element onwards
+	auto element_location = [this](const char* name, int index){
+		const std::string element = std::string(name) + "[" + std::to_string(index) + "]";
+		return glGetUniformLocation(shader_program_, element.c_str());
+	};
+
+	//NOTE: the data needs to be cast to a GLfloat for GLSL to accept the data
+	if (last[kPosition] >= 0){
+		glUniform3fv(element_location("Light_Position", first[kPosition]),
+			last[kPosition] - first[kPosition] + 1,
+			glm::value_ptr(light_positions_[first[kPosition]]));
+		frame_upload_bytes_ += (last[kPosition] - first[kPosition] + 1) * sizeof(glm::vec3);
+	}
+	if (last[kIntensity] >= 0){
+		glUniform3fv(element_location("Light_Intensity", first[kIntensity]),
+			last[kIntensity] - first[kIntensity] + 1,
+			glm::value_ptr(light_intensities_[first[kIntensity]]));
+		frame_upload_bytes_ += (last[kIntensity] - first[kIntensity] + 1) * sizeof(glm::vec3);
+	}
+	if (last[kRange] >= 0){
+		glUniform1fv(element_location("Light_Range", first[kRange]),
+			last[kRange] - first[kRange] + 1,
+			&light_ranges_[first[kRange]]);
+		frame_upload_bytes_ += (last[kRange] - first[kRange] + 1) * sizeof(float);
+	}
+	if (last[kMotion] >= 0){
+		//packed the same way as the instance motions
+		std::vector<glm::vec4> centres, cosines, sines;
+		for (int i = first[kMotion]; i <= last[kMotion]; i++){
+			const auto& motion = light_motions_[i];
+			centres.push_back(glm::vec4(motion.centre, motion.frequency));
+			cosines.push_back(glm::vec4(motion.cosine_axis, motion.phase));
+			sines.push_back(glm::vec4(motion.sine_axis, motion.animated ? 1.f : 0.f));
+		}
+		const int count = last[kMotion] - first[kMotion] + 1;
+		glUniform4fv(element_location("Light_Motion_Centre", first[kMotion]),
+			count, glm::value_ptr(centres[0]));
+		glUniform4fv(element_location("Light_Motion_Cosine", first[kMotion]),
+			count, glm::value_ptr(cosines[0]));
+		glUniform4fv(element_location("Light_Motion_Sine", first[kMotion]),
+			count, glm::value_ptr(sines[0]));
+		frame_upload_bytes_ += 3 * count * sizeof(glm::vec4);
+	}
+
+	//lights are only ever removed from the end, so the count covers removals
+	if (lights_changed){
+		glUniform1i(glGetUniformLocation(shader_program_, "Light_Count"), light_count);
+	}
+}
+
+void MyView::uploadInstanceChanges(const SceneModel::Snapshot& previous,
+	const SceneModel::Snapshot& current,
+	int frame_slot)
+{
+	//the ones that moved into the previous snapshot were drawn part way
+	//last frame, so they are sent once more to settle on it
+	const auto& a = previous.dirty_instances;
+	const auto& b = current.dirty_instances;
+	upload_ranges_.clear();
+	size_t i = 0, j = 0;
+	while (i < a.size() || j < b.size()){
+		const bool take_a = j == b.size() || (i < a.size() && a[i].first < b[j].first);
+		const SceneModel::DirtyRange range = take_a ? a[i++] : b[j++];
+		if (!upload_ranges_.empty()
+			&& range.first <= upload_ranges_.back().first + upload_ranges_.back().count){
+			auto& last = upload_ranges_.back();
+			last.count = std::max(last.first + last.count, range.first + range.count) - last.first;
+		}
+		else{
+			upload_ranges_.push_back(range);
+		}
+	}
+
+	//this frame's copy was last written frames_in_flight frames ago, so it
+	//takes the ranges of every frame since then, this one included
+	recent_instance_ranges_.push_back(upload_ranges_);
+	while ((int)recent_instance_ranges_.size() > frame_pipeline_->framesInFlight()){
+		recent_instance_ranges_.pop_front();
+	}
+	if (recent_instance_ranges_.size() > 1){
+		upload_ranges_.clear();
+		for (const auto& ranges : recent_instance_ranges_){
+			upload_ranges_.insert(upload_ranges_.end(), ranges.begin(), ranges.end());
+		}
+		std::sort(upload_ranges_.begin(), upload_ranges_.end(),
+			[](const SceneModel::DirtyRange& a, const SceneModel::DirtyRange& b){
+			return a.first < b.first;
+		});
+		size_t merged = 0;
+		for (size_t k = 1; k < upload_ranges_.size(); k++){
+			auto& last = upload_ranges_[merged];
+			const auto& range = upload_ranges_[k];
+			if (range.first <= last.first + last.count){
+				last.count = std::max(last.first + last.count, range.first + range.count) - last.first;
+			}
+			else{
+				upload_ranges_[++merged] = range;
+			}
+		}
+		upload_ranges_.resize(std::min(merged + 1, upload_ranges_.size()));
+	}
+	if (upload_ranges_.empty()){
+		return;
+	}
 
-		//unbind the active buffer to ensure no potential faults occur 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	//the frame pipeline has already waited for the GPU to finish with this
+	//copy, so it is written unsynchronized and only the runs sent are flushed
+	const size_t map_first = upload_ranges_.front().first;
+	const size_t map_end = std::min(upload_ranges_.back().first + upload_ranges_.back().count,
+		frame_transforms_.size());
+	if (map_end <= map_first){
+		return;
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, instance_tbos_[frame_slot]);
+	char* mapped = (char*)glMapBufferRange(GL_TEXTURE_BUFFER,
+		map_first * sizeof(glm::mat4x3),
+		(map_end - map_first) * sizeof(glm::mat4x3),
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+	for (const auto& range : upload_ranges_){
+		const size_t end = std::min(range.first + range.count, frame_transforms_.size());
+		//the shader animates some instances from their untouched transforms,
+		//only the runs between them are sent
+		size_t first = range.first;
+		while (first < end){
+			if (gpu_animated_[first]){
+				first++;
+				continue;
+			}
+			size_t last = first + 1;
+			while (last < end && !gpu_animated_[last]){
+				last++;
+			}
+			const size_t bytes = (last - first) * sizeof(glm::mat4x3);
+			if (mapped != nullptr){
+				const size_t offset = (first - map_first) * sizeof(glm::mat4x3);
+				std::memcpy(mapped + offset, &frame_transforms_[first], bytes);
+				glFlushMappedBufferRange(GL_TEXTURE_BUFFER, offset, bytes);
+			}
+			else{
+				glBufferSubData(GL_TEXTURE_BUFFER,
+					first * sizeof(glm::mat4x3), bytes, &frame_transforms_[first]);
+			}
+			frame_upload_bytes_ += bytes;
+			first = last;
+		}
+	}
+	if (mapped != nullptr){
+		glUnmapBuffer(GL_TEXTURE_BUFFER);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
 
-		//update the element count
-		newMesh.element_count = elements.size();
+void MyView::syncMaterials()
+{
+	//materials are part of the static scene so can be read while it runs
+	const unsigned int version = scene_->getVersion(SceneModel::Context::kMaterialClass);
+	if (version == material_version_){
+		return;
+	}
+	scene_->getDirtyRangesSince(SceneModel::Context::kMaterialClass,
+		material_version_, upload_ranges_);
+	material_version_ = version;
+
+	//params are laid out by material slot, like the bindless handles
+	const auto& materials = scene_->getAllMaterials();
+	const size_t slot_count = scene_->getMaterialHandles().slotCount();
+	const bool grow = material_params_.size() < slot_count * kMaterialTexels;
+	if (grow){
+		material_params_.resize(slot_count * kMaterialTexels, glm::vec4(0));
+	}
 
-		glGenVertexArrays(1, &newMesh.vao);
-		glBindVertexArray(newMesh.vao);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newMesh.element_vbo);
+	glBindBuffer(GL_TEXTURE_BUFFER, material_tbo_);
+	for (const auto& range : upload_ranges_){
+		for (size_t i = range.first; i < range.first + range.count; i++){
+			const auto& material = materials[i];
+			const size_t first = SceneModel::HandleTable::slot(material.getId()) * kMaterialTexels;
+			material_params_[first] = glm::vec4(material.getDiffuseColour(), material.getShininess());
+			material_params_[first + 1] = glm::vec4(material.getAmbientColour(), 0.f);
+			material_params_[first + 2] = glm::vec4(material.getSpecularColour(), 0.f);
+			if (!grow){
+				glBufferSubData(GL_TEXTURE_BUFFER, first * sizeof(glm::vec4),
+					kMaterialTexels * sizeof(glm::vec4), &material_params_[first]);
+				frame_upload_bytes_ += kMaterialTexels * sizeof(glm::vec4);
+			}
+		}
+	}
+	if (grow){
+		//a bigger buffer is sent whole and the texture pointed at it again
+		glBufferData(GL_TEXTURE_BUFFER,
+			material_params_.size() * sizeof(glm::vec4),
+			material_params_.data(),
+			GL_DYNAMIC_DRAW);
+		frame_upload_bytes_ += material_params_.size() * sizeof(glm::vec4);
+		glBindTexture(GL_TEXTURE_BUFFER, material_tbo_texture_);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, material_tbo_);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
 
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.positions_vbo);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), TGL_BUFFER_OFFSET(0));
+size_t MyView::getFrameUploadBytes() const
+{
+	return frame_upload_bytes_;
+}
 
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.normals_vbo);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), TGL_BUFFER_OFFSET(0));
+void MyView::setFramesInFlight(int count)
+{
+	//only takes effect when the view next starts
+	frames_in_flight_ = count;
+}
 
-		glBindBuffer(GL_ARRAY_BUFFER, newMesh.texcoords_vbo);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), TGL_BUFFER_OFFSET(0));
+FramePipeline::Stats MyView::getFrameStats() const
+{
+	if (frame_pipeline_ == nullptr){
+		FramePipeline::Stats stats = { frames_in_flight_, 0, 0, 0, 0 };
+		return stats;
+	}
+	return frame_pipeline_->getStats();
+}
 
-		//unbind the active buffer to ensure no potential faults occur 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
+void MyView::resetFrameStats()
+{
+	if (frame_pipeline_ != nullptr){
+		frame_pipeline_->resetStats();
 	}
+}
 
-	/*
-	###################################
-	There are 4 textures for this scene seperated into two categories Diffuse and Specular
-		Ive made things easy for myself by creating:
-			- two textures arrays (to hold the Diffuse / Specular textures)
-			- A Hash Map/un_ordered map (to hold the string value (filename) of the textures,
-										and the index of the array (of where the texture is stored))
-			
-	The hash map will be used in the render method, as I'll Check every instance for a diffuse or specular
-	texture, if one is found I'll then create a texture sampler and send it to the shader and handle it from 
-	there.
-	###################################
-	*/
+bool MyView::hasLoaded() const
+{
+	return loaded_;
+}
 
-	//extract the materials form the scene
-	const auto& sponza_materials = scene_->getAllMaterials();
+void MyView::buildLightLists(const SceneModel::LightIndex::Frustum& view_frustum,
+	int light_count)
+{
+	//the index follows the lights the shader has, moving a light within its
+	//cell costs next to nothing
+	light_index_.resize(light_count);
+	for (int i = 0; i < light_count; i++){
+		light_index_.update(i, light_positions_[i], light_ranges_[i]);
+	}
 
-	//loop through all the materials
-	for (unsigned int i = 0; i < sponza_materials.size(); i++){
-
-		diff_texture_.resize(sponza_materials.size());
-
-		const auto diff_texture_string = sponza_materials[i].getDiffuseTexture();
-
-		const auto spec_texture_string = sponza_materials[i].getSpecularTexture();
-
-		//check to see if the DIFFUSE string is NOT empty, when it isnt that 
-		//means a texture can be created and stored
-		if (diff_texture_string != ""){
-
-			//add the string along with the index value to the hash map
-			textures_.insert({ diff_texture_string, i });
-
-			//Create a texture object from pixel data read from an PNG.
-			tygra::Image texture_image = tygra::imageFromPNG(diff_texture_string);
-
-			if (texture_image.containsData()) {
-				glGenTextures(1, &diff_texture_[i]);
-				glBindTexture(GL_TEXTURE_2D, diff_texture_[i]);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-					GL_LINEAR_MIPMAP_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
-				glTexImage2D(GL_TEXTURE_2D,
-					0,
-					GL_RGBA,
-					texture_image.width(),
-					texture_image.height(),
-					0,
-					pixel_formats[texture_image.componentsPerPixel()],
-					texture_image.bytesPerComponent() == 1 ? GL_UNSIGNED_BYTE
-					: GL_UNSIGNED_SHORT,
-					texture_image.pixels());
-				glGenerateMipmap(GL_TEXTURE_2D);
-				glBindTexture(GL_TEXTURE_2D, 0);
+	//bounding sphere of every instance, the ones outside the view are dropped,
+	//tested in parallel and gathered in order afterwards
+	SceneModel::JobSystem& jobs = SceneModel::JobSystem::shared();
+	const size_t instance_count = scene_->getInstanceCount();
+	const SceneModel::MeshId* instance_mesh_ids = scene_->getInstanceMeshIdArray();
+	instance_light_counts_.assign(instance_count, -1);
+	instance_lights_.resize(instance_count * kMaxInstanceLights);
+	instance_centres_.resize(instance_count);
+	instance_radii_.resize(instance_count);
+	instance_visible_.resize(instance_count);
+	jobs.parallelFor(0, instance_count, kCullGrain, [&](size_t begin, size_t end){
+		for (size_t i = begin; i < end; i++){
+			const glm::mat4 model_xform = glm::mat4(frame_transforms_[i]);
+			const MeshGL& mesh = sponza_mesh_[SceneModel::HandleTable::slot(instance_mesh_ids[i])];
+			const glm::vec3 centre = glm::vec3(model_xform * glm::vec4(mesh.bounds_centre, 1.f));
+			const float scale = glm::max(glm::length(glm::vec3(model_xform[0])),
+				glm::max(glm::length(glm::vec3(model_xform[1])), glm::length(glm::vec3(model_xform[2]))));
+			const float radius = mesh.bounds_radius * scale;
+
+			bool visible = true;
+			for (const auto& plane : view_frustum.planes){
+				if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius){
+					visible = false;
+					break;
+				}
+			}
+			instance_centres_[i] = centre;
+			instance_radii_[i] = radius;
+			instance_visible_[i] = visible;
+		}
+	});
+	visible_instances_.clear();
+	visible_centres_.clear();
+	visible_radii_.clear();
+	for (size_t i = 0; i < instance_count; i++){
+		if (instance_visible_[i]){
+			visible_instances_.push_back(i);
+			visible_centres_.push_back(instance_centres_[i]);
+			visible_radii_.push_back(instance_radii_[i]);
+		}
+	}
 
+	//one batch query for every visible instance
+	light_index_.querySpheres(visible_centres_.data(), visible_radii_.data(),
+		visible_instances_.size(), light_offsets_, candidate_lights_);
+
+	//rank the lights reaching each instance by roughly how much light they
+	//add at the nearest point of its bounds, brightest first, every instance
+	//only writes its own list so they can be ranked in any order
+	jobs.parallelFor(0, visible_instances_.size(), kCullGrain, [&](size_t begin, size_t end){
+		std::vector<std::pair<float, int>> ranked_lights;
+		for (size_t v = begin; v < end; v++){
+			ranked_lights.clear();
+			for (size_t k = light_offsets_[v]; k < light_offsets_[v + 1]; k++){
+				const int light = (int)candidate_lights_[k];
+				const float distance = glm::max(glm::distance(light_positions_[light],
+					visible_centres_[v]) - visible_radii_[v], 0.f);
+				const float attenuation = 1.f - glm::smoothstep(0.f, light_ranges_[light], distance);
+				const float brightness = glm::dot(light_intensities_[light], glm::vec3(0.2126f, 0.7152f, 0.0722f));
+				ranked_lights.push_back(std::make_pair(-brightness * attenuation, light));
 			}
+			const int count = std::min((int)ranked_lights.size(), kMaxInstanceLights);
+			std::partial_sort(ranked_lights.begin(), ranked_lights.begin() + count,
+				ranked_lights.end());
+
+			const size_t instance = visible_instances_[v];
+			instance_light_counts_[instance] = count;
+			for (int k = 0; k < count; k++){
+				instance_lights_[instance * kMaxInstanceLights + k] = ranked_lights[k].second;
+			}
+		}
+	});
+}
 
+void MyView::buildDrawPackets(size_t begin,
+	size_t end,
+	const glm::vec3& camera_position,
+	float screen_scale,
+	std::vector<DrawPacket>& packets) const
+{
+	//read the instances straight from the scene's arrays instead of copying
+	//each one out through its getters, transforms come from this frame's blend
+	const glm::mat4x3* instance_xforms = frame_transforms_.data();
+	const SceneModel::MeshId* instance_mesh_ids = scene_->getInstanceMeshIdArray();
+	const SceneModel::MaterialId* instance_material_ids = scene_->getInstanceMaterialIdArray();
+
+	packets.clear();
+	for (size_t i = begin; i < end; i++){
+		if (useLightLists_ && instance_light_counts_[i] < 0){
+			//outside the view
+			continue;
 		}
 
-		spec_texture_.resize(sponza_materials.size());
-
-		//check to see if the SPECULAR string is NOT empty, when it isnt that 
-		//means a texture can be created and stored
-		if (spec_texture_string != ""){
-
-			//add the string along with the index value to the hash map
-			textures_.insert({ spec_texture_string, i });
-
-			//Create a texture object from pixel data read from an PNG.
-			tygra::Image texture_image = tygra::imageFromPNG(spec_texture_string);
-
-			if (texture_image.containsData()) {
-				glGenTextures(1, &spec_texture_[i]);
-				glBindTexture(GL_TEXTURE_2D, spec_texture_[i]);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-					GL_LINEAR_MIPMAP_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
-				glTexImage2D(GL_TEXTURE_2D,
-					0,
-					GL_RGBA,
-					texture_image.width(),
-					texture_image.height(),
-					0,
-					pixel_formats[texture_image.componentsPerPixel()],
-					texture_image.bytesPerComponent() == 1 ? GL_UNSIGNED_BYTE
-					: GL_UNSIGNED_SHORT,
-					texture_image.pixels());
-				glGenerateMipmap(GL_TEXTURE_2D);
-				glBindTexture(GL_TEXTURE_2D, 0);
+		DrawPacket packet;
+		packet.instance = (unsigned int)i;
+		packet.mesh = (unsigned int)SceneModel::HandleTable::slot(instance_mesh_ids[i]);
+		const MeshGL& mesh = sponza_mesh_[packet.mesh];
+
+		//estimate how many texels of a texture on this instance reach the screen
+		const glm::mat4 model_xform = glm::mat4(instance_xforms[i]);
+		const glm::vec3 bounds_centre = glm::vec3(model_xform * glm::vec4(mesh.bounds_centre, 1.f));
+		const float scale = glm::max(glm::length(glm::vec3(model_xform[0])),
+			glm::max(glm::length(glm::vec3(model_xform[1])), glm::length(glm::vec3(model_xform[2]))));
+		const float bounds_radius = mesh.bounds_radius * scale;
+		const float distance = glm::max(glm::distance(bounds_centre, camera_position) - bounds_radius, 1.f);
+		packet.texture_pixels = (2.f * bounds_radius / distance) * screen_scale / mesh.texcoord_span;
+
+		//MATERIAL
+		//the colours and shininess are fetched by the shader from the
+		//material's slot, the textures are picked here
+		const auto material_instance_id = instance_material_ids[i];
+		const SceneModel::Material& material = scene_->getMaterialById(material_instance_id);
+		packet.material = (unsigned int)SceneModel::HandleTable::slot(material_instance_id);
 
+		//TEXTURES
+		//an empty string or one that never loaded means the shader samples
+		//no texture of that kind for this instance
+		const std::string& diff_texture_string = material.getDiffuseTexture();
+		const std::string& spec_texture_string = material.getSpecularTexture();
+		packet.diffuse_texture = -1;
+		packet.specular_texture = -1;
+		packet.diffuse_layer = 0;
+		packet.specular_layer = 0;
+		if (useBindless_){
+			//the shader finds the handles itself from the material's slot
+			if (packet.material < kMaxMaterials){
+				packet.diffuse_texture = bindless_textures_.handle(diff_texture_string) != 0 ? 0 : -1;
+				packet.specular_texture = bindless_textures_.handle(spec_texture_string) != 0 ? 0 : -1;
+			}
+		}
+		else if (useTextureArrays_){
+			//every array is already bound, a texture is picked by unit and layer
+			const auto diff_slot = texture_arrays_.slot(diff_texture_string);
+			packet.diffuse_texture = diff_slot.unit;
+			packet.diffuse_layer = (float)diff_slot.layer;
+			const auto spec_slot = texture_arrays_.slot(spec_texture_string);
+			packet.specular_texture = spec_slot.unit;
+			packet.specular_layer = (float)spec_slot.layer;
+		}
+		else{
+			if (!diff_texture_string.empty()){
+				const auto got = textures_.find(diff_texture_string);
+				if (got != textures_.end()){
+					packet.diffuse_texture = got->second;
+				}
+			}
+			if (!spec_texture_string.empty()){
+				const auto got = textures_.find(spec_texture_string);
+				if (got != textures_.end()){
+					packet.specular_texture = got->second;
+				}
 			}
-
 		}
+		packets.push_back(packet);
+	}
+}
+
+void MyView::submitDrawPackets()
+{
+	//a uniform is only set when it differs from the last packet's, the
+	//first packet sets them all
+	const DrawUniforms& u = draw_uniforms_;
+	DrawPacket last;
+	bool first = true;
+	GLuint bound_diffuse = 0;
+	GLuint bound_specular = 0;
+
+	for (const auto& packets : draw_chunks_){
+		for (const auto& packet : packets){
+			if (useLightLists_){
+				const int light_count = instance_light_counts_[packet.instance];
+				glUniform1iv(u.instance_lights, light_count,
+					&instance_lights_[packet.instance * kMaxInstanceLights]);
+				glUniform1i(u.instance_light_count, light_count);
+			}
+
+			//the shader fetches the transform itself, only its index is sent
+			glUniform1i(u.instance_index, (GLint)packet.instance);
+			if (first || packet.material != last.material){
+				glUniform1i(u.material_index, (GLint)packet.material);
+			}
 
+			if (useTextureArrays_){
+				if (packet.diffuse_texture >= 0 && (first
+					|| packet.diffuse_texture != last.diffuse_texture
+					|| packet.diffuse_layer != last.diffuse_layer)){
+					glUniform1i(u.diff_tex_sample, packet.diffuse_texture);
+					glUniform1f(u.diff_tex_layer, packet.diffuse_layer);
+				}
+				if (packet.specular_texture >= 0 && (first
+					|| packet.specular_texture != last.specular_texture
+					|| packet.specular_layer != last.specular_layer)){
+					glUniform1i(u.spec_tex_sample, packet.specular_texture);
+					glUniform1f(u.spec_tex_layer, packet.specular_layer);
+				}
+			}
+			else if (!useBindless_){
+				//the streamer hands out a new object whenever the resident mips
+				//change, so compare objects rather than indices
+				if (packet.diffuse_texture >= 0){
+					texture_streamer_->requestSize(packet.diffuse_texture, packet.texture_pixels);
+					const GLuint texture = texture_streamer_->textureObject(packet.diffuse_texture);
+					if (texture != bound_diffuse){
+						glActiveTexture(GL_TEXTURE0);
+						glBindTexture(GL_TEXTURE_2D, texture);
+						bound_diffuse = texture;
+					}
+				}
+				if (packet.specular_texture >= 0){
+					texture_streamer_->requestSize(packet.specular_texture, packet.texture_pixels);
+					const GLuint texture = texture_streamer_->textureObject(packet.specular_texture);
+					if (texture != bound_specular){
+						glActiveTexture(GL_TEXTURE1);
+						glBindTexture(GL_TEXTURE_2D, texture);
+						bound_specular = texture;
+					}
+				}
+			}
+
+			const bool use_diffuse = packet.diffuse_texture >= 0;
+			const bool use_specular = packet.specular_texture >= 0;
+			if (first || use_diffuse != (last.diffuse_texture >= 0)){
+				glUniform1i(u.use_diff_texture, use_diffuse);
+			}
+			if (first || use_specular != (last.specular_texture >= 0)){
+				glUniform1i(u.use_spec_texture, use_specular);
+			}
+
+			//draw the mesh
+			if (first || packet.mesh != last.mesh){
+				glBindVertexArray(sponza_mesh_[packet.mesh].vao);
+			}
+			glDrawElements(GL_TRIANGLES, sponza_mesh_[packet.mesh].element_count, GL_UNSIGNED_INT, 0);
+
+			last = packet;
+			first = false;
+		}
 	}
+	glActiveTexture(GL_TEXTURE0);
+}
 
+void MyView::drawLoadingFrame(float progress)
+{
+	GLint viewport_size[4];
+	glGetIntegerv(GL_VIEWPORT, viewport_size);
+
+	glClearColor(0.f, 0.f, 0.25f, 0.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	//a bar across the middle of the window that fills as tasks finish,
+	//drawn with scissored clears so it needs no shader of its own
+	const int bar_width = viewport_size[2] / 2;
+	const int bar_height = std::max(viewport_size[3] / 40, 4);
+	const int bar_x = viewport_size[0] + (viewport_size[2] - bar_width) / 2;
+	const int bar_y = viewport_size[1] + (viewport_size[3] - bar_height) / 2;
+
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(bar_x, bar_y, bar_width, bar_height);
+	glClearColor(0.1f, 0.1f, 0.4f, 0.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glScissor(bar_x, bar_y, (int)(bar_width * progress), bar_height);
+	glClearColor(0.8f, 0.8f, 0.8f, 0.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
 }
 
 void MyView::windowViewDidReset(std::shared_ptr<tygra::Window> window,
@@ -292,20 +1162,75 @@ void MyView::windowViewDidReset(std::shared_ptr<tygra::Window> window,
 
 void MyView::windowViewDidStop(std::shared_ptr<tygra::Window> window)
 {
+	//abandon whatever has not loaded yet, waits for running decodes
+	loaded_ = false;
+	loader_.reset();
+	SceneModel::JobSystem::shared().wait(loader_jobs_);
+
 	glDeleteProgram(shader_program_);
 
-	for (unsigned int i = 0; i < sponza_mesh_.size(); i++){
-		glDeleteBuffers(1, &sponza_mesh_[i].positions_vbo);
-		glDeleteBuffers(1, &sponza_mesh_[i].normals_vbo);
-		glDeleteBuffers(1, &sponza_mesh_[i].texcoords_vbo);
-		glDeleteBuffers(1, &sponza_mesh_[i].element_vbo);
-		glDeleteVertexArrays(1, &sponza_mesh_[i].vao);
+	//nothing may still be drawing from the per frame copies
+	frame_pipeline_.reset();
+	glDeleteTextures(instance_tbo_textures_.size(), instance_tbo_textures_.data());
+	glDeleteBuffers(instance_tbos_.size(), instance_tbos_.data());
+	instance_tbo_textures_.clear();
+	instance_tbos_.clear();
+	glDeleteTextures(1, &material_tbo_texture_);
+	glDeleteBuffers(1, &material_tbo_);
+	glDeleteTextures(1, &motion_tbo_texture_);
+	glDeleteBuffers(1, &motion_tbo_);
+	material_tbo_texture_ = material_tbo_ = 0;
+	motion_tbo_texture_ = motion_tbo_ = 0;
+
+	for (const auto& mesh : sponza_mesh_){
+		glDeleteBuffers(1, &mesh.positions_vbo);
+		glDeleteBuffers(1, &mesh.normals_vbo);
+		glDeleteBuffers(1, &mesh.texcoords_vbo);
+		glDeleteBuffers(1, &mesh.element_vbo);
+		glDeleteVertexArrays(1, &mesh.vao);
+	}
+	sponza_mesh_.clear();
+	if (uploads_live_ != nullptr){
+		*uploads_live_ = false;
+	}
+	pending_mesh_uploads_ = 0;
+
+	if (texture_streamer_ != nullptr){
+		texture_streamer_->clear();
+	}
+	texture_arrays_.clear();
+	textures_.clear();
+
+	if (useBindless_){
+		bindless_textures_.clear();
+		glDeleteBuffers(1, &material_ubo_);
+		material_ubo_ = 0;
 	}
 
 }
 
 void MyView::windowViewRender(std::shared_ptr<tygra::Window> window)
 {
+	//run a slice of the GL side of loading and show progress until it is done
+	if (loader_ != nullptr){
+		if (!loader_->pump(kLoadingSliceSeconds) || pending_mesh_uploads_ > 0){
+			drawLoadingFrame(loader_->progress());
+			//loading only moves on inside frames, on demand pacing included
+			window->requestFrame();
+			return;
+		}
+		loader_.reset();
+		SceneModel::JobSystem::shared().wait(loader_jobs_);
+
+		const std::chrono::duration<double> load_time
+			= std::chrono::steady_clock::now() - load_start_;
+		std::cout << "Scene loaded in " << load_time.count() << "s" << std::endl;
+		//whatever waited for the scene starts from the next frame, on demand
+		//pacing has to be asked for it
+		loaded_ = true;
+		window->requestFrame();
+	}
+
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 
@@ -314,7 +1239,41 @@ void MyView::windowViewRender(std::shared_ptr<tygra::Window> window)
 	glClearColor(0.f, 0.f, 0.25f, 0.f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	const auto& camera = scene_->getCamera();
+	//the simulation owns the scene's moving parts, draw them blended between
+	//the two newest steps it published
+	const SceneModel::Snapshot* previous = nullptr;
+	const SceneModel::Snapshot* current = nullptr;
+	if (!simulation_->latestSnapshots(previous, current)){
+		return;
+	}
+	const float blend = simulation_->interpolationFactor(*previous, *current);
+
+	//waits for the GPU to finish the frame that last used this slot's copies
+	const int frame_slot = frame_pipeline_->beginFrame();
+
+	//only the dynamic instances ever move, the rest keep their initial transforms
+	//NOTE: blending the matrices elementwise is exact for the translations the
+	//scene animates but would shear rotations
+	//the GPU animated ones are worked out exactly at the blended time with
+	//the same function the shader uses
+	frame_time_ = glm::mix(previous->time, current->time, blend);
+	const SceneModel::AnalyticMotion* instance_motions = scene_->getInstanceMotionArray();
+	const auto& dynamic_instances = scene_->getDynamicInstanceIndices();
+	for (size_t i = 0; i < dynamic_instances.size(); i++){
+		const size_t instance = dynamic_instances[i];
+		if (gpu_animated_[instance]){
+			frame_transforms_[instance][3] = instance_motions[instance].evaluate(frame_time_);
+			continue;
+		}
+		frame_transforms_[instance]
+			= previous->dynamic_transforms[i] * (1.f - blend)
+			+ current->dynamic_transforms[i] * blend;
+	}
+
+	//only what changed is sent, for a still scene that is nothing at all
+	frame_upload_bytes_ = 0;
+	uploadInstanceChanges(*previous, *current, frame_slot);
+	syncMaterials();
 
 	//calc the aspect ratio of the viewport/window
 	GLint viewport_size[4];
@@ -324,9 +1283,14 @@ void MyView::windowViewRender(std::shared_ptr<tygra::Window> window)
 	//create the projection matrix using the aspect ratio
 	glm::mat4 projection_xform = glm::perspective(75.f, aspect_ratio, 1.f, 1000.f);
 
+	//pixels covered by one unit of world space one unit in front of the camera
+	const float screen_scale = viewport_size[3] / (2.f * tanf(glm::radians(75.f) * 0.5f));
+
 	//create a 'scene view matrix' using data provided by the camera
-	auto camera_position = camera.getPosition();
-	auto camera_direction = camera.getDirection();
+	auto camera_position = glm::mix(previous->camera.getPosition(),
+		current->camera.getPosition(), blend);
+	auto camera_direction = glm::normalize(glm::mix(previous->camera.getDirection(),
+		current->camera.getDirection(), blend));
 
 	//Send the camera position data to the shader program, this will be needed when calculating
 	//the specular reflection for the Phong Shading Model
@@ -350,151 +1314,65 @@ void MyView::windowViewRender(std::shared_ptr<tygra::Window> window)
 	glUniformMatrix4fv(projection_view_model_xform_id, 1, GL_FALSE,
 		glm::value_ptr(projection_view_model_xform));
 
-	//get the light info from the scene and pass it to the shader program
-	const auto& sponza_light_ = scene_->getAllLights();
-
-	//create vectors that will hold all the necessary data
-	std::vector<glm::vec3> light_positions;
-	std::vector<glm::vec3> light_intensity;
-	std::vector<float> light_range;
-
-	const int sizeOfArray = sponza_light_.size();
-
-	for (int i = 0; i < sizeOfArray; i++){
-		light_positions.push_back(sponza_light_[i].getPosition());
-		light_intensity.push_back(sponza_light_[i].getIntensity());
-		light_range.push_back(sponza_light_[i].getRange());
+	//the shaders move the animated instances and lights themselves
+	if (useGpuAnimation_){
+		glUniform1f(glGetUniformLocation(shader_program_, "Motion_Time"), frame_time_);
 	}
 
-	//create the Uniform IDs and send the data to the shader program 
-	GLuint light_position_id = glGetUniformLocation(shader_program_, "Light_Position");
-	GLuint light_intensity_id = glGetUniformLocation(shader_program_, "Light_Intensity");
-	GLuint light_range_id = glGetUniformLocation(shader_program_, "Light_Range");
-
-	//NOTE: the data needs to be cast to a GLfloat for GLSL to accept the data
-	glUniform3fv(light_position_id, sizeOfArray, reinterpret_cast<GLfloat *>(light_positions.data()));
-	glUniform3fv(light_intensity_id, sizeOfArray, reinterpret_cast<GLfloat *>(light_intensity.data()));
-	glUniform1fv(light_range_id, sizeOfArray, reinterpret_cast<GLfloat *>(light_range.data()));
-
-	//loop throught every instance/mesh in the scene
-	for (const auto& instance : scene_->getAllInstances()){
-
-		// create and add the model_xform to the shader_program
-		glm::mat4 model_xform = glm::mat4(instance.getTransformationMatrix());
-		GLuint model_xform_id = glGetUniformLocation(shader_program_, "model_xform");
-		glUniformMatrix4fv(model_xform_id, 1, GL_FALSE, glm::value_ptr(model_xform));
-
-		//DIFFUSE
-		//get the material id and create the vec3 from the get material id call
-		auto material_instance_id = instance.getMaterialId();
-		glm::vec3 material_diff_colour = scene_->getMaterialById(material_instance_id).getDiffuseColour();
-
-		//material uniform
-		GLuint diff_material_id = glGetUniformLocation(shader_program_, "diffuse_material_colour");
-		glUniform3fv(diff_material_id, 1, glm::value_ptr(material_diff_colour));
-
-		//AMBIENT
-		glm::vec3 material_amb_colour = scene_->getMaterialById(material_instance_id).getAmbientColour();
-
-		//material uniform
-		GLuint amb_material_id = glGetUniformLocation(shader_program_, "ambient_material_colour");
-		glUniform3fv(amb_material_id, 1, glm::value_ptr(material_amb_colour));
-
-		//TEXTURES
-		//get the diffuse texture string for THIS instance
-		auto diff_texture_string = scene_->getMaterialById(material_instance_id).getDiffuseTexture();
-
-		//get the specular texture string for THIS instance
-		auto spec_texture_string = scene_->getMaterialById(material_instance_id).getSpecularTexture();
+	//send the lights that changed since last frame to the shader program
+	uploadLightChanges(*previous, *current, blend);
 
-		//create a hash map iterator
-		std::unordered_map<std::string, int>::const_iterator got;
+	//then pick which of them each instance in view gets
+	if (useLightLists_){
+		const auto view_frustum = SceneModel::LightIndex::frustumSlice(projection_xform,
+			view_xform, 1.f, 1000.f);
+		buildLightLists(view_frustum, std::min((int)current->lights.size(), kMaxLights));
+	}
 
-		/*
-		####################################
-		If an Empty string is found that means there is no texture associated 
-		with this instance so I send a 'FALSE' bool to the shader and handle it from 
-		there i.e I Dont Sample any Texture
+	//with texture arrays every texture is bound once for the whole frame
+	if (useTextureArrays_){
+		texture_arrays_.bindAll();
+	}
 
-		When the string ISN'T empty I try match it with a Hash Map 'item' by iterating through
-		all the Hash Map 'items', when a match is made i get it's index value and create the 
-		texture sample needed and send a 'TRUE' bool to the shader and handle it from there
-		i.e I DO sample the texture
-		####################################
-		*/
+	//and with bindless textures only the material buffer has to be bound
+	if (useBindless_){
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, material_ubo_);
+	}
 
-		if (diff_texture_string == ""){
-			//no diffuse texture on this instance
-			useDiffTexture_ = false;
-		}
-		else{
-			got = textures_.find(diff_texture_string);
-			if (got == textures_.end()){
-				//no texture found within hash map
-				useDiffTexture_ = false;
-			}
-			else{
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, diff_texture_[got->second]);
-				glUniform1i(glGetUniformLocation(shader_program_, "diff_tex_sample"), 0);
-				useDiffTexture_ = true;
-			}
+	//the shaders read transforms and material params by index from these
+	glActiveTexture(GL_TEXTURE0 + kInstanceUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, instance_tbo_textures_[frame_slot]);
+	glActiveTexture(GL_TEXTURE0 + kMaterialUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, material_tbo_texture_);
+	if (useGpuAnimation_){
+		glActiveTexture(GL_TEXTURE0 + kMotionUnit);
+		glBindTexture(GL_TEXTURE_BUFFER, motion_tbo_texture_);
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	//every instance becomes a draw packet on the job system, a chunk per job,
+	//and only replaying them is left for this thread
+	const size_t instance_count = scene_->getInstanceCount();
+	draw_chunks_.resize((instance_count + kDrawChunkSize - 1) / kDrawChunkSize);
+	SceneModel::JobSystem::shared().parallelFor(0, draw_chunks_.size(), 1,
+		[&](size_t begin, size_t end){
+		for (size_t chunk = begin; chunk < end; chunk++){
+			buildDrawPackets(chunk * kDrawChunkSize,
+				std::min((chunk + 1) * kDrawChunkSize, instance_count),
+				camera_position, screen_scale, draw_chunks_[chunk]);
 		}
-		//check for specular
-		if (spec_texture_string == ""){
-			//no specular texture on this instance
-			useSpecTexture_ = false;
+	});
+	submitDrawPackets();
+
+	//upload finished mips and queue the ones this frame asked for, the
+	//decodes still running are picked up by the frames after
+	if (texture_streamer_ != nullptr){
+		texture_streamer_->update();
+		if (texture_streamer_->getStats().pending_requests > 0){
+			window->requestFrame();
 		}
-		else{
-			got = textures_.find(spec_texture_string);
-			if (got == textures_.end()){
-				//no texture found within hash map
-				useSpecTexture_ = false;
-			}
-			else{
-				glActiveTexture(GL_TEXTURE1);
-				glBindTexture(GL_TEXTURE_2D, spec_texture_[got->second]);
-				glUniform1i(glGetUniformLocation(shader_program_, "spec_tex_sample"), 1);
-				useSpecTexture_ = true;
-			}
-		}
-
-		/*
-		Create and send the Uniform Bool variables the the Shader program.
-			There reason why i have two different booleans (Diff and Spec) is because
-			one instance may have both a Diffuse texture and a Specular texture
-			so i want to be able to handle that properly within the shader
-		*/
-		GLboolean useDiffTexture = useDiffTexture_;
-		GLuint useDiffTexture_id = glGetUniformLocation(shader_program_, "useDiffTexture");
-		glUniform1i(useDiffTexture_id, useDiffTexture);
-
-		GLboolean useSpecTexture = useSpecTexture_;
-		GLuint useSpecTexture_id = glGetUniformLocation(shader_program_, "useSpecTexture");
-		glUniform1i(useSpecTexture_id, useSpecTexture);
-
-		//specular
-		auto specular = scene_->getMaterialById(material_instance_id).getSpecularColour();
-
-		//specular uniform
-		GLuint specular_id = glGetUniformLocation(shader_program_, "specular_colour");
-		glUniform3fv(specular_id, 1, glm::value_ptr(specular));
-
-		//shininess
-		float shininess = scene_->getMaterialById(material_instance_id).getShininess();
-
-		//shininess uniform
-		GLuint shininess_id = glGetUniformLocation(shader_program_, "shininess");
-		glUniform1f(shininess_id, shininess);
-
-		auto id = instance.getMeshId();
-
-		//draw the mesh
-		const MeshGL& mesh = sponza_mesh_[instance.getMeshId()];
-
-		glBindVertexArray(mesh.vao);
-		glDrawElements(GL_TRIANGLES, mesh.element_count, GL_UNSIGNED_INT, 0);
-
 	}
 
+	frame_pipeline_->endFrame();
+
 }
@@ -1,13 +1,21 @@
 #pragma once
 
 #include <SceneModel/SceneModel_fwd.hpp>
+#include <SceneModel/SceneModel.hpp>
 #include <tygra/WindowViewDelegate.hpp>
+#include <tygra/AsyncLoader.hpp>
+#include "TextureStreamer.hpp"
+#include "TextureArrays.hpp"
+#include "BindlessTextures.hpp"
+#include "FramePipeline.hpp"
 #include <tgl/tgl.h>
 #include <glm/glm.hpp>
 #include <vector>
-#include <map>
 #include <memory>
+#include <atomic>
+#include <chrono>
 #include <unordered_map>
+#include <deque>
 
 class MyView : public tygra::WindowViewDelegate
 {
@@ -19,9 +27,48 @@ public:
 
     void setScene(std::shared_ptr<const SceneModel::Context> scene);
 
+	//moving parts of the scene are drawn from its snapshots
+	void setSimulation(std::shared_ptr<SceneModel::Simulation> simulation);
+
 	void setNormalToggle(bool value);
 	bool getToggleNormal(){ return surfaceNormal_; };
 
+	//GPU memory the streamed textures may occupy, can change at runtime
+	void setTextureBudget(size_t bytes);
+	TextureStreamer::Stats getTextureStats() const;
+
+	//pack same sized textures into texture arrays, set before the view starts
+	void setTextureArrays(bool value);
+
+	//use ARB_bindless_texture when the driver has it, set before the view starts
+	void setBindlessTextures(bool allowed);
+
+	//light each instance with only its most significant lights and skip the
+	//ones outside the view, set before the view starts
+	void setLightLists(bool value);
+
+	//evaluate the scene's closed form motions in the shaders from the frame
+	//time instead of sending the moving instances and lights every frame,
+	//set before the view starts
+	void setGpuAnimation(bool value);
+
+	//bytes of instance, material and light data sent to the GPU by the last
+	//frame
+	size_t getFrameUploadBytes() const;
+
+	//frames the CPU may run ahead of the GPU, each with its own copy of the
+	//per frame data, set before the view starts
+	void setFramesInFlight(int count);
+
+	//CPU time spent waiting on frame fences and GPU time spent waiting for
+	//frames since the last reset
+	FramePipeline::Stats getFrameStats() const;
+	void resetFrameStats();
+
+	//true from the first frame drawn after loading until the view stops,
+	//safe from any thread
+	bool hasLoaded() const;
+
 private:
 
     void
@@ -39,18 +86,175 @@ private:
     windowViewRender(std::shared_ptr<tygra::Window> window) override;
 
     std::shared_ptr<const SceneModel::Context> scene_;
+    std::shared_ptr<SceneModel::Simulation> simulation_;
+
+	//every instance transform for this frame, dynamic ones blended
+	std::vector<glm::mat4x3> frame_transforms_;
 
 private:
 
+	struct MeshGL;
+
+	//GL side of loading, each runs as a task on the GL thread
+	void createShaderProgram(const std::string& vertex_shader_string,
+							 const std::string& fragment_shader_string);
+
+	//buffers may be filled on the window's upload thread, the vertex array
+	//is made on the GL thread once they are ready
+	static void uploadMesh(const SceneModel::Mesh& scene_mesh, MeshGL& newMesh);
+
+	static void createVertexArray(MeshGL& newMesh);
+
+	//bounds and texcoord span, safe to run on a worker
+	static void measureMesh(const SceneModel::Mesh& scene_mesh, MeshGL& newMesh);
+
+	void drawLoadingFrame(float progress);
+
+	//send only the lights that changed since the last upload, positions are
+	//blended between the two snapshots
+	void uploadLightChanges(const SceneModel::Snapshot& previous,
+							const SceneModel::Snapshot& current,
+							float blend);
+
+	//send the transforms of the instances the snapshots say moved, except the
+	//ones the shader animates, to the frame slot's copy of the transforms
+	void uploadInstanceChanges(const SceneModel::Snapshot& previous,
+							   const SceneModel::Snapshot& current,
+							   int frame_slot);
+
+	//send the materials changed since material_version_
+	void syncMaterials();
+
+	//everything the GL thread needs to draw one instance, worked out from
+	//the scene and the view's lookups without touching GL
+	struct DrawPacket
+	{
+		unsigned int instance;
+		unsigned int mesh;
+		unsigned int material;
+		//streamed texture index or texture array unit, -1 when there is no
+		//texture of the kind to sample, bindless only uses the sign
+		int diffuse_texture;
+		int specular_texture;
+		float diffuse_layer;
+		float specular_layer;
+		//how many texels of its textures roughly reach the screen
+		float texture_pixels;
+	};
+
+	//packets for the instances in [begin, end), safe to run on a job
+	void buildDrawPackets(size_t begin,
+						  size_t end,
+						  const glm::vec3& camera_position,
+						  float screen_scale,
+						  std::vector<DrawPacket>& packets) const;
+
+	//replay every chunk's packets in order, skipping state that is already set
+	void submitDrawPackets();
+
+	//pick the lights for every instance in view, -1 lights marks the rest
+	void buildLightLists(const SceneModel::LightIndex::Frustum& view_frustum,
+						 int light_count);
+
+	//runs the startup tasks, reset once everything has loaded, its worker
+	//tasks count against loader_jobs_
+	SceneModel::JobSystem::Group loader_jobs_;
+	std::unique_ptr<tygra::AsyncLoader> loader_;
+	std::chrono::steady_clock::time_point load_start_;
+	std::atomic<bool> loaded_;
+
 	bool surfaceNormal_ = false;
-	bool useDiffTexture_ = false;
-	bool useSpecTexture_ = false;
+	bool useTextureArrays_ = false;
+	bool allowBindless_ = true;
+	bool useBindless_ = false;
+	bool useLightLists_ = false;
+	bool useGpuAnimation_ = false;
 
-	GLuint shader_program_;
-	std::vector<GLuint> diff_texture_;
-	std::vector<GLuint> spec_texture_;
+	GLuint shader_program_ = 0;
 
+	//texture file name -> index into the texture streamer
 	std::unordered_map<std::string, int> textures_;
+	std::unique_ptr<TextureStreamer> texture_streamer_;
+	size_t texture_budget_;
+	TextureArrays texture_arrays_;
+
+	//bindless path, handles for every material live in material_ubo_ at the
+	//slot of the material's handle
+	BindlessTextures bindless_textures_;
+	GLuint material_ubo_ = 0;
+	static const unsigned int kMaxMaterials = 1024;
+
+	//copies of the shader's light arrays, kept in step with the scene through
+	//its light generation so unchanged lights are never re-sent
+	unsigned int light_generation_ = 0;
+	std::vector<glm::vec3> light_positions_;
+	std::vector<glm::vec3> light_intensities_;
+	std::vector<float> light_ranges_;
+	static const int kMaxLights = 22;
+
+	//GPU animation path, every instance's motion lives in motion_tbo_ as
+	//three texels and the lights' in uniform arrays, all sent only when they
+	//change, the shaders evaluate them at frame_time_
+	GLuint motion_tbo_ = 0;
+	GLuint motion_tbo_texture_ = 0;
+	std::vector<unsigned char> gpu_animated_;
+	std::vector<SceneModel::AnalyticMotion> light_motions_;
+	float frame_time_ = 0;
+	static const int kMotionTexels = 3;
+
+	//one list of packets per kDrawChunkSize instances, rebuilt every frame
+	std::vector<std::vector<DrawPacket>> draw_chunks_;
+	static const size_t kDrawChunkSize = 256;
+
+	struct DrawUniforms
+	{
+		GLint instance_index;
+		GLint material_index;
+		GLint diff_tex_sample;
+		GLint diff_tex_layer;
+		GLint spec_tex_sample;
+		GLint spec_tex_layer;
+		GLint use_diff_texture;
+		GLint use_spec_texture;
+		GLint instance_lights;
+		GLint instance_light_count;
+	};
+	DrawUniforms draw_uniforms_;
+
+	//light lists path, kMaxInstanceLights light indices per instance
+	SceneModel::LightIndex light_index_;
+	std::vector<int> instance_lights_;
+	std::vector<int> instance_light_counts_;
+	std::vector<glm::vec3> instance_centres_;
+	std::vector<float> instance_radii_;
+	std::vector<unsigned char> instance_visible_;
+	std::vector<size_t> visible_instances_;
+	std::vector<glm::vec3> visible_centres_;
+	std::vector<float> visible_radii_;
+	std::vector<size_t> light_offsets_;
+	std::vector<size_t> candidate_lights_;
+	static const int kMaxInstanceLights = 8;
+
+	//instance transforms and material parameters live in texture buffers the
+	//shaders index, only the ranges the scene reports as changed are re-sent
+	//the transforms change every frame so each frame in flight has its own
+	//copy, which catches up on the ranges of every frame since it was last
+	//used
+	int frames_in_flight_ = 2;
+	std::unique_ptr<FramePipeline> frame_pipeline_;
+	std::vector<GLuint> instance_tbos_;
+	std::vector<GLuint> instance_tbo_textures_;
+	std::deque<std::vector<SceneModel::DirtyRange>> recent_instance_ranges_;
+	GLuint material_tbo_ = 0;
+	GLuint material_tbo_texture_ = 0;
+	unsigned int material_version_ = 0;
+	std::vector<glm::vec4> material_params_;
+	std::vector<SceneModel::DirtyRange> upload_ranges_;
+	size_t frame_upload_bytes_ = 0;
+	static const int kMaterialTexels = 3;
+	static const int kMotionUnit = 13;
+	static const int kInstanceUnit = 14;
+	static const int kMaterialUnit = 15;
 
 
 	struct MeshGL{
@@ -62,14 +266,28 @@ private:
 
 		int element_count;
 
+		//bounding sphere and how many times the texcoords wrap across the
+		//mesh, used to estimate how many texels are visible on screen
+		glm::vec3 bounds_centre;
+		float bounds_radius;
+		float texcoord_span;
+
 		MeshGL() : positions_vbo(0),
 				   normals_vbo(0),
 				   texcoords_vbo(0),
 				   element_vbo(0),
 				   vao(0),
-				   element_count(0){}
+				   element_count(0),
+				   bounds_radius(0),
+				   texcoord_span(1){}
 	};
 
-	std::map<SceneModel::MeshId, MeshGL> sponza_mesh_;
+	//indexed by SceneModel::HandleTable::slot of the mesh id, a mesh with
+	//no vertex array yet is still uploading
+	std::vector<MeshGL> sponza_mesh_;
+	int pending_mesh_uploads_ = 0;
+
+	//cleared when the view stops so uploads still in flight are thrown away
+	std::shared_ptr<bool> uploads_live_;
 
 };
@@ -0,0 +1,257 @@
+#include "TextureArrays.hpp"
+#include <tygra/FileHelper.hpp>
+#include <tygra/TextureContainer.hpp>
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+TextureArrays::TextureArrays() : unit_limit_(0)
+{
+}
+
+TextureArrays::~TextureArrays()
+{
+}
+
+void TextureArrays::setUnitLimit(int units)
+{
+	unit_limit_ = units;
+}
+
+void TextureArrays::addTexture(const std::string& filepath)
+{
+	if (slots_.find(filepath) != slots_.end()){
+		return;
+	}
+	Slot slot = { -1, 0 };
+	slots_.insert({ filepath, slot });
+	filepaths_.push_back(filepath);
+	sources_.push_back(nullptr);
+}
+
+int TextureArrays::textureCount() const
+{
+	return filepaths_.size();
+}
+
+void TextureArrays::decodeTexture(int index)
+{
+	const std::string& filepath = filepaths_[index];
+
+	tygra::TextureContainer container;
+	if (container.open(tygra::containerPathForPNG(filepath))
+		&& (!container.isCompressed()
+			|| tglIsAvailable(TGL_EXTENSION_EXT_TEXTURE_COMPRESSION_S3TC))) {
+		sources_[index].reset(new Source(std::move(container), tygra::Image()));
+		return;
+	}
+	sources_[index].reset(new Source(tygra::TextureContainer(),
+									 tygra::imageFromPNG(filepath)));
+}
+
+void TextureArrays::build()
+{
+	for (int i = 0; i < textureCount(); i++){
+		decodeTexture(i);
+	}
+	upload();
+}
+
+void TextureArrays::upload()
+{
+	//width, height, components per pixel, bytes per component, then the
+	//internal format and level count of containers (zero for PNGs)
+	typedef std::tuple<int, int, int, int, GLenum, int> GroupKey;
+
+	std::map<GroupKey, std::vector<int>> groups;
+
+	for (int i = 0; i < textureCount(); i++){
+		if (sources_[i] == nullptr){
+			decodeTexture(i);
+		}
+		const tygra::TextureContainer& container = sources_[i]->container;
+		const tygra::Image& image = sources_[i]->image;
+		if (container.isOpen()) {
+			GroupKey key(container.width(), container.height(), 0, 0,
+						 container.glInternalFormat(), container.levelCount());
+			groups[key].push_back(i);
+		}
+		else if (image.containsData()){
+			GroupKey key(image.width(), image.height(),
+						 image.componentsPerPixel(), image.bytesPerComponent(),
+						 0, 0);
+			groups[key].push_back(i);
+		}
+	}
+
+	GLint max_units = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_units);
+	if (unit_limit_ > 0){
+		max_units = std::min(max_units, (GLint)unit_limit_);
+	}
+
+	GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (const auto& group : groups){
+		if ((int)arrays_.size() == max_units){
+			//out of texture units, the rest keep unit -1 and draw untextured
+			break;
+		}
+
+		const int width = std::get<0>(group.first);
+		const int height = std::get<1>(group.first);
+		const int components = std::get<2>(group.first);
+		const int bytes_per_component = std::get<3>(group.first);
+		const GLenum type = bytes_per_component == 1 ? GL_UNSIGNED_BYTE
+													 : GL_UNSIGNED_SHORT;
+		const bool from_containers = std::get<4>(group.first) != 0;
+		const int layer_count = group.second.size();
+
+		GLuint array = 0;
+		glGenTextures(1, &array);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+			GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		if (from_containers) {
+			uploadContainers(group.second);
+		}
+		else {
+			glTexImage3D(GL_TEXTURE_2D_ARRAY,
+				0,
+				GL_RGBA,
+				width,
+				height,
+				layer_count,
+				0,
+				pixel_formats[components],
+				type,
+				nullptr);
+
+			for (int layer = 0; layer < layer_count; layer++){
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+					0,
+					0, 0, layer,
+					width, height, 1,
+					pixel_formats[components],
+					type,
+					sources_[group.second[layer]]->image.pixels());
+			}
+
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		}
+
+		for (int layer = 0; layer < layer_count; layer++){
+			Slot& slot = slots_[filepaths_[group.second[layer]]];
+			slot.unit = arrays_.size();
+			slot.layer = layer;
+		}
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		arrays_.push_back(array);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	//the pixels live on the GPU now
+	for (auto& source : sources_){
+		source.reset();
+	}
+}
+
+void TextureArrays::uploadContainers(const std::vector<int>& layers)
+{
+	//every layer shares the format and mip chain of the first
+	const tygra::TextureContainer& first = sources_[layers[0]]->container;
+	const int layer_count = layers.size();
+	const GLenum internal_format = first.glInternalFormat();
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL,
+		first.levelCount() - 1);
+	for (unsigned int level = 0; level < first.levelCount(); level++){
+		const int width = first.levelWidth(level);
+		const int height = first.levelHeight(level);
+		if (first.isCompressed()) {
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY,
+				level,
+				internal_format,
+				width,
+				height,
+				layer_count,
+				0,
+				first.levelSize(level) * layer_count,
+				nullptr);
+		}
+		else {
+			glTexImage3D(GL_TEXTURE_2D_ARRAY,
+				level,
+				internal_format,
+				width,
+				height,
+				layer_count,
+				0,
+				first.glFormat(),
+				first.glType(),
+				nullptr);
+		}
+
+		for (int layer = 0; layer < layer_count; layer++){
+			const tygra::TextureContainer& container = sources_[layers[layer]]->container;
+			if (container.isCompressed()) {
+				glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+					level,
+					0, 0, layer,
+					width, height, 1,
+					internal_format,
+					container.levelSize(level),
+					container.levelData(level));
+			}
+			else {
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+					level,
+					0, 0, layer,
+					width, height, 1,
+					container.glFormat(),
+					container.glType(),
+					container.levelData(level));
+			}
+		}
+	}
+}
+
+TextureArrays::Slot TextureArrays::slot(const std::string& filepath) const
+{
+	auto got = slots_.find(filepath);
+	if (got == slots_.end()){
+		Slot none = { -1, 0 };
+		return none;
+	}
+	return got->second;
+}
+
+void TextureArrays::bindAll() const
+{
+	for (unsigned int i = 0; i < arrays_.size(); i++){
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, arrays_[i]);
+	}
+}
+
+int TextureArrays::arrayCount() const
+{
+	return arrays_.size();
+}
+
+void TextureArrays::clear()
+{
+	if (!arrays_.empty()){
+		glDeleteTextures(arrays_.size(), arrays_.data());
+	}
+	arrays_.clear();
+	slots_.clear();
+	filepaths_.clear();
+	sources_.clear();
+}
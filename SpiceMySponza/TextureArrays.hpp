@@ -0,0 +1,88 @@
+#pragma once
+
+#include <tgl/tgl.h>
+#include <tygra/TextureContainer.hpp>
+#include <tygra/Image.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/*
+Packs textures of the same size and format into GL_TEXTURE_2D_ARRAY objects.
+
+Add every texture file, call build() once, then bind all of the arrays at the
+start of a frame with bindAll(). build() can also be split so the files are
+decoded on other threads: decodeTexture() for each index, then upload() on the
+GL thread. A texture is then selected per draw purely
+through uniforms: the texture unit of its array and its layer in that array,
+so the draw loop never has to bind a texture.
+
+DDS containers next to the PNGs are grouped by their own format and keep
+their stored mip chain, PNGs get their mips generated.
+*/
+class TextureArrays
+{
+public:
+
+	struct Slot
+	{
+		int unit;
+		int layer;
+	};
+
+	TextureArrays();
+
+	~TextureArrays();
+
+	void addTexture(const std::string& filepath);
+
+	//arrays only use units below this, the default is every unit the
+	//fragment shader has
+	void setUnitLimit(int units);
+
+	int textureCount() const;
+
+	//read the container or PNG of one added texture, no GL calls so any
+	//thread may decode any index as long as no two decode the same one
+	void decodeTexture(int index);
+
+	//create one array per size and format from the decoded textures, any
+	//texture not decoded yet is decoded here first
+	void upload();
+
+	//decodeTexture() for every added texture then upload()
+	void build();
+
+	//where the texture ended up, unit is -1 if it failed to load
+	Slot slot(const std::string& filepath) const;
+
+	//bind every array to its own texture unit starting at GL_TEXTURE0
+	void bindAll() const;
+
+	int arrayCount() const;
+
+	void clear();
+
+private:
+
+	//each file has either an open container or a decoded image
+	struct Source
+	{
+		tygra::TextureContainer container;
+		tygra::Image image;
+
+		Source(tygra::TextureContainer&& container, tygra::Image&& image)
+			: container(std::move(container)), image(std::move(image)){}
+	};
+
+	//allocate and fill every mip level of the bound array from containers
+	void uploadContainers(const std::vector<int>& layers);
+
+	std::vector<std::string> filepaths_;
+	std::vector<std::unique_ptr<Source>> sources_;
+	std::unordered_map<std::string, Slot> slots_;
+	std::vector<GLuint> arrays_;
+	int unit_limit_;
+
+};
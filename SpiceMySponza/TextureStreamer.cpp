@@ -0,0 +1,543 @@
+#include "TextureStreamer.hpp"
+#include <tygra/PNGDecoder.hpp>
+#include <tygra/TextureContainer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+//resident_level of a texture still showing its 1x1 placeholder
+static const int kPlaceholderLevel = 32;
+
+//average each 2x2 block of texels, odd edges reuse the last row/column
+template <typename T>
+static void downsampleTexels(const T* src, int src_width, int src_height,
+							 T* dst, int dst_width, int dst_height,
+							 int components)
+{
+	for (int y = 0; y < dst_height; y++){
+		const int y0 = std::min(y * 2, src_height - 1);
+		const int y1 = std::min(y * 2 + 1, src_height - 1);
+		for (int x = 0; x < dst_width; x++){
+			const int x0 = std::min(x * 2, src_width - 1);
+			const int x1 = std::min(x * 2 + 1, src_width - 1);
+			for (int c = 0; c < components; c++){
+				const unsigned int sum = src[(y0 * src_width + x0) * components + c]
+					+ src[(y0 * src_width + x1) * components + c]
+					+ src[(y1 * src_width + x0) * components + c]
+					+ src[(y1 * src_width + x1) * components + c];
+				dst[(y * dst_width + x) * components + c] = T((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+static int levelCountFor(int width, int height)
+{
+	int count = 1;
+	int size = std::max(width, height);
+	while (size > 1){
+		size /= 2;
+		count++;
+	}
+	return count;
+}
+
+static int floorLevelFor(int width, int height, int level_count)
+{
+	int level = 0;
+	while (level < level_count - 1
+		   && std::max(width >> level, height >> level) > TextureStreamer::kFloorSize){
+		level++;
+	}
+	return level;
+}
+
+TextureStreamer::TextureStreamer(size_t budget_bytes) :
+	budget_bytes_(budget_bytes),
+	resident_bytes_(0),
+	pending_requests_(0),
+	budget_overruns_(0),
+	evictions_(0),
+	frame_(1),
+	live_(std::make_shared<bool>(true)),
+	stop_(false)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	clear();
+}
+
+int TextureStreamer::addTexture(const std::string& filepath)
+{
+	TextureState texture;
+	texture.filepath = filepath;
+	texture.width = 0;
+	texture.height = 0;
+	texture.layout.internal_format = GL_RGBA;
+	texture.layout.pixel_format = GL_RGBA;
+	texture.layout.pixel_type = GL_UNSIGNED_BYTE;
+	texture.layout.texel_bytes = 4;
+	texture.layout.block_bytes = 0;
+	texture.level_count = 0;
+	texture.floor_level = 0;
+	texture.resident_level = kPlaceholderLevel;
+	texture.pending_level = -1;
+	texture.desired_level = kPlaceholderLevel;
+	texture.resident_bytes = 4;
+	texture.last_used_frame = 0;
+
+	//mid grey stand in until the floor mips arrive
+	const unsigned char grey[4] = { 128, 128, 128, 255 };
+	glGenTextures(1, &texture.texture);
+	glBindTexture(GL_TEXTURE_2D, texture.texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+				 GL_RGBA, GL_UNSIGNED_BYTE, grey);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	resident_bytes_ += texture.resident_bytes;
+
+	const int index = textures_.size();
+	textures_.push_back(texture);
+
+	//a negative top level asks for the floor mips
+	Request request = { index, -1, filepath };
+	queueRequest(request);
+	pending_requests_++;
+	textures_[index].pending_level = kPlaceholderLevel;
+
+	return index;
+}
+
+GLuint TextureStreamer::textureObject(int index) const
+{
+	return textures_[index].texture;
+}
+
+void TextureStreamer::requestSize(int index, float pixels)
+{
+	TextureState& texture = textures_[index];
+	texture.last_used_frame = frame_;
+	if (texture.level_count == 0) {
+		return;
+	}
+	texture.desired_level = std::min(texture.desired_level,
+									  levelForSize(texture, pixels));
+}
+
+void TextureStreamer::update()
+{
+	std::vector<Result> results;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		results.swap(results_);
+	}
+
+	//upload whatever the jobs finished since last frame
+	for (auto& result : results){
+		TextureState& texture = textures_[result.index];
+		pending_requests_--;
+		texture.pending_level = -1;
+		if (result.levels.empty()) {
+			//failed decode, keep the placeholder and never ask again
+			continue;
+		}
+		if (result.top_level < 0) {
+			texture.width = result.width;
+			texture.height = result.height;
+			texture.layout = result.layout;
+			texture.level_count = levelCountFor(result.width, result.height);
+			texture.floor_level = floorLevelFor(result.width, result.height,
+												texture.level_count);
+			texture.floor_levels = std::make_shared<const std::vector<MipLevel>>(
+				std::move(result.levels));
+			if (texture.resident_level > texture.floor_level) {
+				upload(texture, texture.floor_level, texture.floor_levels);
+			}
+		}
+		else if (result.top_level < texture.resident_level) {
+			upload(texture, result.top_level,
+				std::make_shared<const std::vector<MipLevel>>(std::move(result.levels)));
+		}
+	}
+
+	//bytes already promised to requests still in flight
+	size_t reserved_bytes = 0;
+	for (const auto& texture : textures_){
+		if (texture.pending_level >= 0 && texture.level_count > 0) {
+			reserved_bytes += chainBytes(texture, texture.pending_level)
+				- std::min(texture.resident_bytes,
+						   chainBytes(texture, texture.pending_level));
+		}
+	}
+
+	//request sharper mips for textures drawn this frame
+	std::vector<Request> new_requests;
+	for (int i = 0; i < (int)textures_.size(); i++){
+		TextureState& texture = textures_[i];
+		if (texture.last_used_frame != frame_
+			|| texture.level_count == 0
+			|| texture.pending_level >= 0
+			|| texture.desired_level >= texture.resident_level) {
+			continue;
+		}
+		const size_t needed = chainBytes(texture, texture.desired_level)
+							  - texture.resident_bytes;
+
+		//make room by dropping textures that were not drawn this frame
+		while (resident_bytes_ + reserved_bytes + needed > budget_bytes_) {
+			TextureState* victim = nullptr;
+			for (auto& other : textures_){
+				if (other.last_used_frame == frame_
+					|| other.resident_level >= other.floor_level) {
+					continue;
+				}
+				if (victim == nullptr
+					|| other.last_used_frame < victim->last_used_frame) {
+					victim = &other;
+				}
+			}
+			if (victim == nullptr) {
+				break;
+			}
+			evictToFloor(*victim);
+		}
+		if (resident_bytes_ + reserved_bytes + needed > budget_bytes_) {
+			budget_overruns_++;
+			continue;
+		}
+
+		Request request = { i, texture.desired_level, texture.filepath };
+		new_requests.push_back(request);
+		texture.pending_level = texture.desired_level;
+		reserved_bytes += needed;
+	}
+
+	//the budget may have shrunk, drop least recently used textures to fit
+	while (resident_bytes_ > budget_bytes_) {
+		TextureState* victim = nullptr;
+		for (auto& texture : textures_){
+			if (texture.resident_level >= texture.floor_level) {
+				continue;
+			}
+			if (victim == nullptr
+				|| texture.last_used_frame < victim->last_used_frame) {
+				victim = &texture;
+			}
+		}
+		if (victim == nullptr) {
+			break;
+		}
+		if (victim->last_used_frame == frame_) {
+			budget_overruns_++;
+		}
+		evictToFloor(*victim);
+	}
+
+	for (const auto& request : new_requests){
+		queueRequest(request);
+	}
+	pending_requests_ += new_requests.size();
+
+	for (auto& texture : textures_){
+		texture.desired_level = kPlaceholderLevel;
+	}
+	frame_++;
+}
+
+void TextureStreamer::setBudget(size_t budget_bytes)
+{
+	budget_bytes_ = budget_bytes;
+}
+
+void TextureStreamer::setUploader(Uploader uploader)
+{
+	uploader_ = uploader;
+}
+
+TextureStreamer::Stats TextureStreamer::getStats() const
+{
+	Stats stats;
+	stats.resident_bytes = resident_bytes_;
+	stats.budget_bytes = budget_bytes_;
+	stats.pending_requests = pending_requests_;
+	stats.budget_overruns = budget_overruns_;
+	stats.evictions = evictions_;
+	return stats;
+}
+
+void TextureStreamer::clear()
+{
+	//queued decodes see stop_ and return straight away
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	SceneModel::JobSystem::shared().wait(decodes_);
+	results_.clear();
+	*live_ = false;
+	live_ = std::make_shared<bool>(true);
+
+	for (auto& texture : textures_){
+		glDeleteTextures(1, &texture.texture);
+	}
+	textures_.clear();
+	resident_bytes_ = 0;
+	pending_requests_ = 0;
+}
+
+void TextureStreamer::queueRequest(const Request& request)
+{
+	SceneModel::JobSystem::shared().run(decodes_, [this, request]{
+		decode(request);
+	});
+}
+
+void TextureStreamer::decode(const Request& request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stop_) {
+			return;
+		}
+	}
+
+	Result result;
+	result.index = request.index;
+	result.top_level = request.top_level;
+	result.width = 0;
+	result.height = 0;
+
+	if (!readContainer(request, result)) {
+		decodePNG(request, result);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	results_.push_back(std::move(result));
+}
+
+//a container with a full mip chain is copied as is, no decoding
+bool TextureStreamer::readContainer(const Request& request, Result& result)
+{
+	tygra::TextureContainer container;
+	const bool use_container
+		= container.open(tygra::containerPathForPNG(request.filepath))
+		&& (!container.isCompressed()
+			|| tglIsAvailable(TGL_EXTENSION_EXT_TEXTURE_COMPRESSION_S3TC))
+		&& (int)container.levelCount()
+		   == levelCountFor(container.width(), container.height());
+	if (!use_container) {
+		return false;
+	}
+
+	result.width = container.width();
+	result.height = container.height();
+	result.layout.internal_format = container.glInternalFormat();
+	result.layout.pixel_format = container.glFormat();
+	result.layout.pixel_type = container.glType();
+	result.layout.texel_bytes = 4;
+	result.layout.block_bytes = container.blockBytes();
+
+	const int level_count = container.levelCount();
+	const int top_level = request.top_level < 0
+		? floorLevelFor(result.width, result.height, level_count)
+		: std::min(request.top_level, level_count - 1);
+	for (int i = top_level; i < level_count; i++){
+		MipLevel level;
+		level.width = container.levelWidth(i);
+		level.height = container.levelHeight(i);
+		const unsigned char* bytes
+			= (const unsigned char*)container.levelData(i);
+		level.data.assign(bytes, bytes + container.levelSize(i));
+		result.levels.push_back(std::move(level));
+	}
+	return true;
+}
+
+void TextureStreamer::decodePNG(const Request& request, Result& result)
+{
+	//decode straight into the top mip level, no intermediate image
+	tygra::PNGDecoder decoder;
+	MipLevel level;
+	bool decoded = decoder.open(request.filepath);
+	if (decoded) {
+		level.width = decoder.width();
+		level.height = decoder.height();
+		level.data.resize(decoder.outputSize());
+		decoded = decoder.begin(level.data.data(), decoder.outputRowBytes());
+		while (decoded && !decoder.isComplete()) {
+			decoded = decoder.decodeRows(decoder.height());
+		}
+	}
+	if (decoded) {
+		result.width = level.width;
+		result.height = level.height;
+		const int components = decoder.nativeComponentsPerPixel();
+		const int bytes_per_component = decoder.nativeBytesPerComponent();
+		const GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+		result.layout.internal_format = GL_RGBA;
+		result.layout.pixel_format = pixel_formats[components];
+		result.layout.pixel_type = bytes_per_component == 1
+			? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+		//the driver stores every level as four channel texels
+		result.layout.texel_bytes = 4 * bytes_per_component;
+		result.layout.block_bytes = 0;
+
+		const int level_count = levelCountFor(result.width, result.height);
+		const int top_level = request.top_level < 0
+			? floorLevelFor(result.width, result.height, level_count)
+			: std::min(request.top_level, level_count - 1);
+
+		for (int i = 0; i < level_count; i++){
+			MipLevel next;
+			if (i + 1 < level_count) {
+				next.width = std::max(1, level.width / 2);
+				next.height = std::max(1, level.height / 2);
+				next.data.resize(next.width * next.height
+								 * components
+								 * bytes_per_component);
+				if (bytes_per_component == 2) {
+					downsampleTexels((const uint16_t*)level.data.data(),
+									 level.width, level.height,
+									 (uint16_t*)next.data.data(),
+									 next.width, next.height,
+									 components);
+				}
+				else {
+					downsampleTexels(level.data.data(),
+									 level.width, level.height,
+									 next.data.data(),
+									 next.width, next.height,
+									 components);
+				}
+			}
+			if (i >= top_level) {
+				result.levels.push_back(std::move(level));
+			}
+			level = std::move(next);
+		}
+	}
+}
+
+void TextureStreamer::upload(TextureState& texture,
+							 int top_level,
+							 SharedLevels levels)
+{
+	//levels always run from top_level down to 1x1, skip the front of the
+	//floor chain when top_level lies inside it
+	const int first = top_level - (texture.level_count - (int)levels->size());
+
+	texture.resident_level = top_level;
+	resident_bytes_ -= texture.resident_bytes;
+	texture.resident_bytes = chainBytes(texture, top_level);
+	resident_bytes_ += texture.resident_bytes;
+
+	const int index = int(&texture - textures_.data());
+	const PixelLayout layout = texture.layout;
+	auto new_texture = std::make_shared<GLuint>(0);
+	auto work = [layout, first, levels, new_texture]{
+		*new_texture = createTexture(layout, first, *levels);
+	};
+	//ready calls for one texture arrive in the order they were uploaded
+	auto live = live_;
+	auto ready = [this, index, new_texture, live]{
+		if (!*live) {
+			glDeleteTextures(1, new_texture.get());
+			return;
+		}
+		TextureState& texture = textures_[index];
+		glDeleteTextures(1, &texture.texture);
+		texture.texture = *new_texture;
+	};
+	if (uploader_ != nullptr) {
+		uploader_(work, ready);
+	}
+	else {
+		work();
+		ready();
+	}
+}
+
+GLuint TextureStreamer::createTexture(const PixelLayout& layout,
+									  int first,
+									  const std::vector<MipLevel>& levels)
+{
+	GLuint new_texture = 0;
+	glGenTextures(1, &new_texture);
+	glBindTexture(GL_TEXTURE_2D, new_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+		GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+		levels.size() - first - 1);
+
+	//small mips of RGB images are not 4 byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int i = first; i < (int)levels.size(); i++){
+		if (layout.block_bytes != 0) {
+			glCompressedTexImage2D(GL_TEXTURE_2D,
+				i - first,
+				layout.internal_format,
+				levels[i].width,
+				levels[i].height,
+				0,
+				levels[i].data.size(),
+				levels[i].data.data());
+		}
+		else {
+			glTexImage2D(GL_TEXTURE_2D,
+				i - first,
+				layout.internal_format,
+				levels[i].width,
+				levels[i].height,
+				0,
+				layout.pixel_format,
+				layout.pixel_type,
+				levels[i].data.data());
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return new_texture;
+}
+
+void TextureStreamer::evictToFloor(TextureState& texture)
+{
+	if (texture.resident_level >= texture.floor_level) {
+		return;
+	}
+	upload(texture, texture.floor_level, texture.floor_levels);
+	evictions_++;
+}
+
+size_t TextureStreamer::chainBytes(const TextureState& texture,
+								   int top_level) const
+{
+	size_t bytes = 0;
+	for (int i = top_level; i < texture.level_count; i++){
+		const size_t width = std::max(1, texture.width >> i);
+		const size_t height = std::max(1, texture.height >> i);
+		if (texture.layout.block_bytes != 0) {
+			bytes += ((width + 3) / 4) * ((height + 3) / 4)
+					 * texture.layout.block_bytes;
+		}
+		else {
+			bytes += width * height * texture.layout.texel_bytes;
+		}
+	}
+	return bytes;
+}
+
+int TextureStreamer::levelForSize(const TextureState& texture,
+								  float pixels) const
+{
+	const float size = (float)std::max(texture.width, texture.height);
+	const float ratio = size / std::max(pixels, 1.f);
+	const int level = ratio <= 1.f ? 0 : (int)std::floor(std::log2(ratio));
+	return std::min(level, texture.floor_level);
+}
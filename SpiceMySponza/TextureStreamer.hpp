@@ -0,0 +1,178 @@
+#pragma once
+
+#include <SceneModel/JobSystem.hpp>
+#include <tgl/tgl.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+
+/*
+Streams mip levels of 2D textures in and out of GPU memory.
+
+Mip levels come from a DDS container next to the PNG when there is one,
+otherwise they are decoded from the PNG and box filtered by the decode job.
+
+Every texture starts as a 1x1 placeholder and gets its small "floor" mips
+(the levels no bigger than kFloorSize) from a job straight after startup.
+Higher levels are only decoded when something on screen needs them, which
+the view reports each frame with requestSize(). When the resident total
+goes over the budget the least recently used textures are dropped back to
+their floor mips.
+
+All methods must be called from the GL thread. Every request is decoded by
+its own job on the shared SceneModel::JobSystem, a texture only ever has one
+request in flight, and the jobs only touch the result queue. With an uploader
+the decoded mips are also uploaded away from the GL thread, a texture keeps
+drawing with its old object until the new one is ready.
+*/
+class TextureStreamer
+{
+public:
+
+	struct Stats
+	{
+		size_t resident_bytes;
+		size_t budget_bytes;
+		int pending_requests;
+		int budget_overruns;
+		int evictions;
+	};
+
+	//runs GL work somewhere with a shared context, then 'ready' back on the
+	//GL thread once the GPU has finished it, e.g. tygra::Window::upload
+	typedef std::function<void(std::function<void()> work,
+							   std::function<void()> ready)> Uploader;
+
+	explicit TextureStreamer(size_t budget_bytes);
+
+	~TextureStreamer();
+
+	//register a PNG file and queue its floor mips, returns the texture index
+	int addTexture(const std::string& filepath);
+
+	//GL texture object to bind for the given index, this changes whenever
+	//the resident mip range changes so look it up every frame
+	GLuint textureObject(int index) const;
+
+	//report that the texture is drawn covering roughly 'pixels' pixels
+	//across this frame, also marks the texture as used for the LRU
+	void requestSize(int index, float pixels);
+
+	//uploads finished decodes, issues new requests and evicts under budget
+	void update();
+
+	void setBudget(size_t budget_bytes);
+
+	//without one textures are uploaded on the GL thread during update()
+	void setUploader(Uploader uploader);
+
+	Stats getStats() const;
+
+	//delete every texture object, waits for the running decodes
+	void clear();
+
+	static const int kFloorSize = 64;
+
+private:
+
+	struct MipLevel
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> data;
+	};
+
+	//how levels are uploaded, block_bytes is 0 for uncompressed texels
+	struct PixelLayout
+	{
+		GLenum internal_format;
+		GLenum pixel_format;
+		GLenum pixel_type;
+		int texel_bytes;
+		int block_bytes;
+	};
+
+	struct Request
+	{
+		int index;
+		int top_level;
+		std::string filepath;
+	};
+
+	struct Result
+	{
+		int index;
+		int top_level;
+		int width;
+		int height;
+		PixelLayout layout;
+		std::vector<MipLevel> levels;
+	};
+
+	struct TextureState
+	{
+		std::string filepath;
+		GLuint texture;
+		int width;
+		int height;
+		PixelLayout layout;
+		int level_count;
+		int floor_level;
+		int resident_level;
+		int pending_level;
+		int desired_level;
+		size_t resident_bytes;
+		unsigned int last_used_frame;
+		std::shared_ptr<const std::vector<MipLevel>> floor_levels;
+	};
+
+	typedef std::shared_ptr<const std::vector<MipLevel>> SharedLevels;
+
+	void queueRequest(const Request& request);
+
+	//runs as a job, the result waits in results_ for update()
+	void decode(const Request& request);
+
+	//job side loaders, readContainer returns false if there is no usable
+	//container and decodePNG leaves result.levels empty on failure
+	bool readContainer(const Request& request, Result& result);
+
+	void decodePNG(const Request& request, Result& result);
+
+	//the budget counts the new levels straight away, the texture object is
+	//only swapped once the uploader says they are ready
+	void upload(TextureState& texture,
+				int top_level,
+				SharedLevels levels);
+
+	//makes a texture object holding levels from 'first' down, may run on
+	//the uploader's thread so it only touches its arguments
+	static GLuint createTexture(const PixelLayout& layout,
+								int first,
+								const std::vector<MipLevel>& levels);
+
+	void evictToFloor(TextureState& texture);
+
+	size_t chainBytes(const TextureState& texture, int top_level) const;
+
+	int levelForSize(const TextureState& texture, float pixels) const;
+
+	std::vector<TextureState> textures_;
+	size_t budget_bytes_;
+	size_t resident_bytes_;
+	int pending_requests_;
+	int budget_overruns_;
+	int evictions_;
+	unsigned int frame_;
+
+	Uploader uploader_;
+	//cleared by clear() so uploads still in flight throw their texture away
+	std::shared_ptr<bool> live_;
+
+	SceneModel::JobSystem::Group decodes_;
+	mutable std::mutex mutex_;
+	std::vector<Result> results_;
+	bool stop_;
+};
@@ -1,8 +1,11 @@
 #include <crtdbg.h>
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <tygra/Window.hpp>
+#include <tygra/Package.hpp>
 #include "MyController.hpp"
 
 int main(int argc, char *argv[])
@@ -12,8 +15,17 @@ int main(int argc, char *argv[])
 
     try {
 
-        auto controller = std::make_shared<MyController>();
+        // serve shaders and textures from the asset package when present
+        tygra::Package package;
+        if (package.open("sponza.pak")) {
+            tygra::mountPackage(&package);
+        }
+
+        const std::vector<std::string> options(argv + 1, argv + argc);
+        auto controller = std::make_shared<MyController>(options);
         auto window = tygra::Window::mainWindow();
+        window->setRenderThread(controller->wantsRenderThread());
+        window->setUploadThread(controller->wantsUploadThread());
         window->setController(controller);
 
         const int window_width = 1280;
@@ -27,6 +39,7 @@ int main(int argc, char *argv[])
             }
             window->close();
         }
+        tygra::mountPackage(nullptr);
 
     } catch (std::exception e) {
         std::cerr << "Opps ... something went wrong:" << std::endl;
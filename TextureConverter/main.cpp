@@ -0,0 +1,42 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <tygra/TextureContainer.hpp>
+
+/*
+Converts PNG textures into DDS containers that SpiceMySponza loads in place
+of the PNG whenever one sits next to it.
+
+  TextureConverter [--uncompressed] <file.png>...
+
+Textures are block compressed (BC1, or BC3 when they have alpha) unless
+--uncompressed asks for RGBA8. Every container holds a full mip chain.
+*/
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: TextureConverter [--uncompressed] <file.png>..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool compress = true;
+    int failures = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--uncompressed") {
+            compress = false;
+            continue;
+        }
+        const std::string dds_filepath = tygra::containerPathForPNG(arg);
+        if (tygra::writeTextureContainer(arg, dds_filepath, compress)) {
+            std::cout << arg << " -> " << dds_filepath << std::endl;
+        } else {
+            std::cerr << "Failed to convert " << arg << std::endl;
+            ++failures;
+        }
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
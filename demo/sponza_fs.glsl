@@ -1,19 +1,57 @@
 #version 330
+#ifdef USE_BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
 
 uniform vec3 Camera_Position;
 
 uniform vec3 Light_Position[22];
 uniform vec3 Light_Intensity[22];
 uniform float Light_Range[22];
-
-uniform vec3 diffuse_material_colour;
-uniform vec3 ambient_material_colour;
-uniform vec3 specular_colour;
-uniform float shininess;
-
+uniform int Light_Count;
+
+#ifdef USE_ANALYTIC_MOTION
+//each light's closed form motion, packed like the instance motions, a light
+//with a zero in Light_Motion_Sine.w sits at Light_Position instead
+uniform vec4 Light_Motion_Centre[22];
+uniform vec4 Light_Motion_Cosine[22];
+uniform vec4 Light_Motion_Sine[22];
+uniform float Motion_Time;
+#endif
+
+#ifdef USE_LIGHT_LISTS
+//indices of the most significant lights for this instance, picked on the CPU
+uniform int Instance_Lights[MAX_INSTANCE_LIGHTS];
+uniform int Instance_Light_Count;
+#endif
+
+//three texels per material slot: diffuse colour and shininess, ambient
+//colour, specular colour
+uniform samplerBuffer material_params;
+uniform int material_index;
+
+vec3 diffuse_material_colour;
+vec3 ambient_material_colour;
+vec3 specular_colour;
+float shininess;
+
+#if defined(USE_BINDLESS_TEXTURES)
+//diffuse handle in xy and specular handle in zw for every material
+#define MAX_MATERIALS 1024
+layout(std140) uniform MaterialTextures
+{
+	uvec4 material_textures[MAX_MATERIALS];
+};
+#elif defined(USE_TEXTURE_ARRAYS)
+uniform sampler2DArray diff_tex_sample;
+uniform sampler2DArray spec_tex_sample;
+uniform float diff_tex_layer;
+uniform float spec_tex_layer;
+#else
 uniform sampler2D diff_tex_sample;
 
 uniform sampler2D spec_tex_sample;
+#endif
 
 
 uniform bool useDiffTexture;
@@ -27,24 +65,61 @@ in vec2 texcoords;
 
 out vec4 fragment_colour;
 
-vec3 Lights[22];
-
 vec3 newLight(vec3 lightPos, vec3 vertPos, float lightRange, vec3 light_intensity);
 
+vec3 lightPosition(int i)
+{
+#ifdef USE_ANALYTIC_MOTION
+	if (Light_Motion_Sine[i].w != 0.0){
+		float angle = Light_Motion_Centre[i].w * Motion_Time + Light_Motion_Cosine[i].w;
+		return Light_Motion_Centre[i].xyz
+			+ Light_Motion_Cosine[i].xyz * cos(angle)
+			+ Light_Motion_Sine[i].xyz * sin(angle);
+	}
+#endif
+	return Light_Position[i];
+}
+
 void main(void)
 {
-	for (int i = 0; i < 22; i++){
-		Lights[i] = newLight(Light_Position[i], P, Light_Range[i], Light_Intensity[i]);
+	vec4 diffuse_shininess = texelFetch(material_params, material_index * 3);
+	diffuse_material_colour = diffuse_shininess.rgb;
+	shininess = diffuse_shininess.a;
+	ambient_material_colour = texelFetch(material_params, material_index * 3 + 1).rgb;
+	specular_colour = texelFetch(material_params, material_index * 3 + 2).rgb;
+
+	vec3 allLights = vec3(0, 0, 0);
+#ifdef USE_LIGHT_LISTS
+	for (int k = 0; k < Instance_Light_Count; k++){
+		int i = Instance_Lights[k];
+		allLights += newLight(lightPosition(i), P, Light_Range[i], Light_Intensity[i]);
+	}
+#else
+	for (int i = 0; i < Light_Count; i++){
+		allLights += newLight(lightPosition(i), P, Light_Range[i], Light_Intensity[i]);
 	}
+#endif
 
-	vec3 allLights= vec3(Lights[0] + Lights[1] + Lights[2] + Lights[3] + Lights[4] + Lights[5] +
-						  Lights[6] + Lights[7] + Lights[8] + Lights[9] + Lights[10] + Lights[11] + Lights[12] + 
-						  Lights[13] + Lights[14] + Lights[15] + Lights[16] + Lights[17] + Lights[19] + Lights[20] + 
-						  Lights[21]);
+#if defined(USE_BINDLESS_TEXTURES)
+	//a zero handle must never be sampled so only read the ones in use
+	vec3 diff_texture = vec3(1.0);
+	if (useDiffTexture == true){
+		diff_texture = texture(sampler2D(material_textures[material_index].xy), texcoords).rgb;
+	}
+
+	vec3 spec_texture = vec3(1.0);
+	if (useSpecTexture == true){
+		spec_texture = texture(sampler2D(material_textures[material_index].zw), texcoords).rgb;
+	}
+#elif defined(USE_TEXTURE_ARRAYS)
+	vec3 diff_texture = texture(diff_tex_sample, vec3(texcoords, diff_tex_layer)).rgb;
 
+	vec3 spec_texture = texture(spec_tex_sample, vec3(texcoords, spec_tex_layer)).rgb;
+#else
 	vec3 diff_texture = texture(diff_tex_sample, texcoords).rgb;
 
 	vec3 spec_texture = texture(spec_tex_sample, texcoords).rgb;
+#endif
 
 	vec3 textures = diff_texture * spec_texture;
 
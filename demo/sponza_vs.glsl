@@ -1,7 +1,19 @@
 #version 330
 
 uniform mat4 projection_view_model_xform;
-uniform mat4 model_xform;
+
+//every instance's mat4x3, its 12 floats packed column after column into
+//three texels
+uniform samplerBuffer instance_xforms;
+uniform int instance_index;
+
+#ifdef USE_ANALYTIC_MOTION
+//three texels per instance: centre and frequency, cosine axis and phase,
+//sine axis and whether it moves at all, evaluated at Motion_Time to give
+//the instance's position
+uniform samplerBuffer instance_motions;
+uniform float Motion_Time;
+#endif
 
 in vec3 vertex_position;
 in vec3 vertex_normal;
@@ -14,6 +26,23 @@ out vec2 texcoords;
 
 void main(void)
 {
+	vec4 a = texelFetch(instance_xforms, instance_index * 3);
+	vec4 b = texelFetch(instance_xforms, instance_index * 3 + 1);
+	vec4 c = texelFetch(instance_xforms, instance_index * 3 + 2);
+	mat4 model_xform = mat4(vec4(a.xyz, 0.0),
+							vec4(a.w, b.xy, 0.0),
+							vec4(b.zw, c.x, 0.0),
+							vec4(c.yzw, 1.0));
+#ifdef USE_ANALYTIC_MOTION
+	vec4 m0 = texelFetch(instance_motions, instance_index * 3);
+	vec4 m1 = texelFetch(instance_motions, instance_index * 3 + 1);
+	vec4 m2 = texelFetch(instance_motions, instance_index * 3 + 2);
+	if (m2.w != 0.0){
+		float angle = m0.w * Motion_Time + m1.w;
+		model_xform[3].xyz = m0.xyz + m1.xyz * cos(angle) + m2.xyz * sin(angle);
+	}
+#endif
+
 	P = vec3(model_xform * vec4(vertex_position, 1.0));
 	N = vec3(mat3(model_xform) * normalize(vertex_normal));
 
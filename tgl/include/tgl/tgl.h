@@ -416,6 +416,8 @@ typedef enum _TGLEXTENTION {
     TGL_EXTENSION_GL_4_5,
     TGL_EXTENSION_ARB_DEBUG_OUTPUT,
     TGL_EXTENSION_AMD_DEBUG_OUTPUT,
+    TGL_EXTENSION_ARB_BINDLESS_TEXTURE,
+    TGL_EXTENSION_EXT_TEXTURE_COMPRESSION_S3TC,
     TGL_EXTENSION_MAX
 } TGLEXTENSION;
 
@@ -1966,6 +1968,25 @@ extern PFNGLDEBUGMESSAGECALLBACKAMDPROC glDebugMessageCallbackAMD;
 extern PFNGLGETDEBUGMESSAGELOGAMDPROC glGetDebugMessageLogAMD;
 #endif
 
+/* ARB_bindless_texture */
+#if 1
+#define TGL_DEFINE_ARB_BINDLESS_TEXTURE
+extern PFNGLGETTEXTUREHANDLEARBPROC glGetTextureHandleARB;
+extern PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glMakeTextureHandleResidentARB;
+extern PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glMakeTextureHandleNonResidentARB;
+extern PFNGLUNIFORMHANDLEUI64ARBPROC glUniformHandleui64ARB;
+extern PFNGLISTEXTUREHANDLERESIDENTARBPROC glIsTextureHandleResidentARB;
+#endif
+
+/* EXT_texture_compression_s3tc - copied from glext.h available from opengl.org */
+#ifndef GL_EXT_texture_compression_s3tc
+#define GL_EXT_texture_compression_s3tc
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT  0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#endif /* EXT_texture_compression_s3tc */
+
 
 #ifdef __cplusplus
 }
@@ -24,6 +24,7 @@ distribution.
 
 #define TGL_TARGET_GL_4_5
 #include <tgl/tgl.h>
+#include <string.h>
 
 #if defined(TGL_PLATFORM_COCOA)
     //#include <Foundation/Foundation.h>
@@ -835,9 +836,34 @@ PFNGLDEBUGMESSAGECALLBACKAMDPROC glDebugMessageCallbackAMD = 0;
 PFNGLGETDEBUGMESSAGELOGAMDPROC glGetDebugMessageLogAMD = 0;
 #endif
 
+/* ARB_bindless_texture */
+#if defined(TGL_DEFINE_ARB_BINDLESS_TEXTURE)
+PFNGLGETTEXTUREHANDLEARBPROC glGetTextureHandleARB = 0;
+PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glMakeTextureHandleResidentARB = 0;
+PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glMakeTextureHandleNonResidentARB = 0;
+PFNGLUNIFORMHANDLEUI64ARBPROC glUniformHandleui64ARB = 0;
+PFNGLISTEXTUREHANDLERESIDENTARBPROC glIsTextureHandleResidentARB = 0;
+#endif
+
 /* success variables */
 static GLboolean tgl_extensions[TGL_EXTENSION_MAX];
 
+/* query the driver's extension list, needs GL 3.0 glGetStringi */
+static GLboolean _tglIsExtensionAdvertised(const char *name) {
+    GLint count = 0;
+    GLint i;
+    if (!tglIsAvailable(TGL_EXTENSION_GL_3_0)) {
+        return GL_FALSE;
+    }
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (i=0; i<count; ++i) {
+        if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0) {
+            return GL_TRUE;
+        }
+    }
+    return GL_FALSE;
+}
+
 /* callback to display GL debug messages */
 void APIENTRY _tglDebugLog(GLenum source,
                            GLenum type,
@@ -1786,6 +1812,24 @@ void tglInit(void) {
         tgl_extensions[TGL_EXTENSION_AMD_DEBUG_OUTPUT] = GL_FALSE;
 #endif
     }
+    /* ARB_bindless_texture */
+    /* some drivers export the entry points without supporting the extension */
+    if (_tglIsExtensionAdvertised("GL_ARB_bindless_texture")) {
+#ifdef TGL_DEFINE_ARB_BINDLESS_TEXTURE
+        LOADFUNC(PFNGLGETTEXTUREHANDLEARBPROC, glGetTextureHandleARB, tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE])
+        LOADFUNC(PFNGLMAKETEXTUREHANDLERESIDENTARBPROC, glMakeTextureHandleResidentARB, tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE])
+        LOADFUNC(PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC, glMakeTextureHandleNonResidentARB, tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE])
+        LOADFUNC(PFNGLUNIFORMHANDLEUI64ARBPROC, glUniformHandleui64ARB, tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE])
+        LOADFUNC(PFNGLISTEXTUREHANDLERESIDENTARBPROC, glIsTextureHandleResidentARB, tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE])
+#else
+        tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE] = GL_FALSE;
+#endif
+    } else {
+        tgl_extensions[TGL_EXTENSION_ARB_BINDLESS_TEXTURE] = GL_FALSE;
+    }
+    /* EXT_texture_compression_s3tc, formats only */
+    tgl_extensions[TGL_EXTENSION_EXT_TEXTURE_COMPRESSION_S3TC]
+        = _tglIsExtensionAdvertised("GL_EXT_texture_compression_s3tc");
 #ifdef TGL_DEBUG
     if (tglIsAvailable(TGL_EXTENSION_ARB_DEBUG_OUTPUT)) {
         glDebugMessageCallbackARB(_tglDebugLog, NULL);
@@ -0,0 +1,149 @@
+/**
+ * @file    AsyncLoader.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_ASYNCLOADER__
+#define __TYGRA_ASYNCLOADER__
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace tygra
+{
+
+/**
+ Runs a graph of loading tasks. Worker tasks (file reads, decodes, CPU
+ preprocessing) run concurrently on a pool of threads, main thread tasks
+ (anything touching GL) only run inside AsyncLoader#pump. A task starts once
+ every task it depends on has finished, so results are handed between tasks
+ through state the lambdas share.
+ @remark    An exception thrown by a task stops further scheduling and is
+            rethrown from the next call to AsyncLoader#pump.
+ */
+class AsyncLoader
+{
+public:
+
+    typedef int TaskId;
+
+    enum Thread
+    {
+        kWorkerThread,
+        kMainThread
+    };
+
+    /**
+     Runs a ready worker task somewhere else, it must not run the task
+     before returning.
+     */
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    /**
+     @param worker_count    Number of worker threads, zero picks one fewer
+                            than the hardware threads (at least one).
+     */
+    explicit AsyncLoader(unsigned int worker_count = 0);
+
+    /**
+     Hands the worker tasks to a thread pool the application already has
+     instead of starting threads of its own.
+     @param executor    Called with each worker task once it is ready.
+     */
+    explicit AsyncLoader(Executor executor);
+
+    /**
+     Waits for running worker tasks to finish, tasks not yet started are
+     abandoned, including the ones already handed to the executor.
+     */
+    ~AsyncLoader();
+
+    /**
+     Adds a task to the graph, it becomes ready once all of its dependencies
+     have finished. Tasks can be added from inside other tasks.
+     @param thread          Where the task must run.
+     @param work            The task itself.
+     @param dependencies    Tasks that must finish first.
+     @return                Identifies the task as a dependency of others.
+     */
+    TaskId
+    addTask(Thread thread,
+            std::function<void()> work,
+            const std::vector<TaskId>& dependencies = std::vector<TaskId>());
+
+    /**
+     Runs ready main thread tasks until none are ready or the time budget is
+     spent. Call once per frame from the thread that owns the GL context.
+     @param seconds     Time budget, at least one ready task always runs.
+     @return            Boolean indicating every task has finished.
+     */
+    bool
+    pump(double seconds);
+
+    /**
+     Pumps until every task has finished, for loading without a frame loop.
+     */
+    void
+    wait();
+
+    bool
+    isComplete() const;
+
+    /**
+     Fraction of the added tasks that have finished, in the range [0,1].
+     */
+    float
+    progress() const;
+
+private:
+
+    AsyncLoader(const AsyncLoader&);
+    AsyncLoader& operator=(const AsyncLoader&);
+
+    struct Task
+    {
+        Thread thread;
+        std::function<void()> work;
+        int waiting_count;
+        bool finished;
+        std::vector<TaskId> dependents;
+    };
+
+    void
+    workerLoop();
+
+    void
+    runTask(TaskId id);
+
+    // what the executor runs, skips the task once stopped
+    void
+    runDispatched(TaskId id);
+
+    // requires mutex_ to be held
+    void
+    makeReady(TaskId id);
+
+    std::deque<Task> tasks_;
+    std::deque<TaskId> worker_ready_;
+    std::deque<TaskId> main_ready_;
+    int finished_count_;
+    std::exception_ptr error_;
+    bool stop_;
+
+    Executor executor_;
+    int dispatched_count_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable worker_wake_;
+    std::condition_variable main_wake_;
+};
+
+} // end namespace tygra
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file    CommandQueue.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_COMMANDQUEUE__
+#define __TYGRA_COMMANDQUEUE__
+
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace tygra
+{
+
+/**
+ A bounded first in first out queue of work handed from one thread to
+ another, e.g. frames from the main thread to a render thread. Pushing
+ blocks while the queue is full so the producer can never run more than
+ a fixed number of commands ahead of the consumer.
+ */
+class CommandQueue
+{
+public:
+
+    typedef std::function<void()> Command;
+
+    /**
+     @param capacity    Most commands waiting at once, at least one.
+     */
+    explicit CommandQueue(size_t capacity);
+
+    /**
+     Adds a command to the back, waiting for room first if the queue is
+     full.
+     */
+    void
+    push(Command command);
+
+    /**
+     Waits until there is room for a command or the time runs out.
+     @param seconds     Longest time to wait.
+     @return            Boolean indicating there is room, which stays true
+                        until someone else pushes.
+     */
+    bool
+    waitForRoom(double seconds);
+
+    /**
+     Removes the command at the front, waiting for one if the queue is
+     empty.
+     */
+    Command
+    pop();
+
+    size_t
+    size() const;
+
+    size_t
+    capacity() const;
+
+private:
+
+    CommandQueue(const CommandQueue&);
+    CommandQueue& operator=(const CommandQueue&);
+
+    std::deque<Command> commands_;
+    size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+} // end namespace tygra
+
+#endif
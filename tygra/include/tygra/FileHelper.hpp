@@ -15,6 +15,8 @@ namespace tygra
 {
     /**
      * Construct a new string object with the contents of a text file.
+     * The file is served from the mounted package when it holds an entry
+     * with the same name.
      * @param   A valid, full path to a text file to read.
      * @return  The new new string object
      */
@@ -23,6 +25,8 @@ namespace tygra
 
     /**
      * Construct a new image object with the contents of a PNG file.
+     * The file is served from the mounted package when it holds an entry
+     * with the same name.
      * @param   A valid path to the PNG file to read.
      * @return  The new image object.
      */
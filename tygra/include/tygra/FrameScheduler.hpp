@@ -0,0 +1,139 @@
+/**
+ * @file    FrameScheduler.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_FRAMESCHEDULER__
+#define __TYGRA_FRAMESCHEDULER__
+
+#include <atomic>
+
+namespace tygra
+{
+
+/**
+ Decides when a Window draws its next frame and measures how evenly the
+ frames arrive. Every Window has one, see Window#frameScheduler.
+ @remark    Only FrameScheduler#requestFrame may be called from any thread,
+            everything else belongs to the thread calling Window#update.
+ */
+class FrameScheduler
+{
+public:
+
+    enum Mode
+    {
+        /** Draw at the target rate without vsync, sleeping for most of the
+            time left and spinning through the last of it. While in this
+            mode the Windows timer runs at 1ms so sleeps wake on time. */
+        kFixedRate,
+        /** Sync to the display but tear rather than wait a whole refresh
+            when a frame is late, the default. */
+        kAdaptiveVsync,
+        /** Draw as fast as possible, for benchmarks. */
+        kUncapped,
+        /** Only draw when input arrives or FrameScheduler#requestFrame is
+            called, otherwise wait for events without using the CPU. */
+        kOnDemand
+    };
+
+    /**
+     Frame to frame intervals since the last reset, in seconds.
+     */
+    struct Stats
+    {
+        int frames;
+        double mean_seconds;
+        double variance;
+        double shortest_seconds;
+        double longest_seconds;
+    };
+
+    FrameScheduler();
+
+    ~FrameScheduler();
+
+    void
+    setMode(Mode mode);
+
+    Mode
+    mode() const;
+
+    /**
+     @param frames_per_second   Rate kept in kFixedRate mode, 60 by default.
+     */
+    void
+    setTargetRate(double frames_per_second);
+
+    double
+    targetRate() const;
+
+    /**
+     The argument for glfwSwapInterval that suits the mode.
+     */
+    int
+    swapInterval() const;
+
+    /**
+     Asks for a frame in kOnDemand mode, ignored by the other modes.
+     */
+    void
+    requestFrame();
+
+    /**
+     Takes the frame request, if there is one.
+     @return    Boolean indicating a frame was requested since the last call.
+     */
+    bool
+    takeRequest();
+
+    /**
+     In kFixedRate mode blocks until the next frame is due, otherwise
+     returns straight away. A frame later than a whole period moves the
+     schedule on rather than hurrying the frames after it.
+     */
+    void
+    waitUntilDue();
+
+    /**
+     Marks the end of a frame, the interval since the previous one goes into
+     the stats.
+     */
+    void
+    frameFinished();
+
+    Stats
+    getStats() const;
+
+    void
+    resetStats();
+
+    /**
+     Seconds on a monotonic clock with sub-microsecond resolution.
+     */
+    static double
+    now();
+
+private:
+
+    std::atomic<int> mode_;
+    double period_;
+    std::atomic<bool> requested_;
+
+    double next_due_;
+    // how late sleeps have been waking up, the wait spins for this long
+    double sleep_slack_;
+
+    double last_frame_;
+    int frames_;
+    double mean_;
+    // sum of squared differences from the mean (Welford)
+    double squares_;
+    double shortest_;
+    double longest_;
+};
+
+} // end namespace tygra
+
+#endif
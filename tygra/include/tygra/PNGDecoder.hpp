@@ -0,0 +1,179 @@
+/**
+ * @file    PNGDecoder.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_PNGDECODER__
+#define __TYGRA_PNGDECODER__
+
+#include "Package.hpp"
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+// forward declare libpng types to avoid #include polution
+struct png_struct_def;
+struct png_info_def;
+
+namespace tygra
+{
+
+/**
+ Decodes a PNG file row by row straight into memory owned by the caller.
+ Rows are written bottom-up (the first PNG row lands in the last destination
+ row) so the result is ready for glTexImage2D without a second copy.
+ Channel count and bit depth conversion happens inside libpng while decoding.
+ @remark    Decoding can be spread across several frames by calling
+            PNGDecoder#decodeRows with a small row count until it completes.
+ */
+class PNGDecoder
+{
+public:
+
+    PNGDecoder();
+
+    ~PNGDecoder();
+
+    /**
+     Opens the file and reads the PNG header. The file is served from the
+     mounted package when it holds an entry with the same name.
+     @param filepath    A valid path to the PNG file to read.
+     @return            Boolean indicating success of the operation.
+     */
+    bool
+    open(std::string filepath);
+
+    /**
+     Reads the PNG header from a PNG file already in memory.
+     @param data    Start of the PNG file, must stay valid until closed.
+     @param size    Number of bytes in the PNG file.
+     @return        Boolean indicating success of the operation.
+     */
+    bool
+    open(const void* data,
+         size_t size);
+
+    /**
+     Width of the image in pixels, valid once open.
+     */
+    unsigned int
+    width() const;
+
+    /**
+     Height of the image in pixels, valid once open.
+     */
+    unsigned int
+    height() const;
+
+    /**
+     Components per pixel the image decodes to when no format is requested,
+     palette and low bit depth images count as expanded.
+     */
+    unsigned int
+    nativeComponentsPerPixel() const;
+
+    /**
+     Bytes per component the image decodes to when no format is requested.
+     */
+    unsigned int
+    nativeBytesPerComponent() const;
+
+    /**
+     Requests the layout of the decoded pixels. Missing alpha is filled
+     opaque, colour is converted to grey when fewer than three components are
+     asked for, and 16 bit components are little-endian.
+     Must be called before PNGDecoder#begin.
+     @param components_per_pixel    1 to 4.
+     @param bytes_per_component     1 or 2.
+     */
+    void
+    setOutputFormat(unsigned int components_per_pixel,
+                    unsigned int bytes_per_component);
+
+    /**
+     Number of bytes in one tightly packed decoded row.
+     */
+    size_t
+    outputRowBytes() const;
+
+    /**
+     Number of bytes needed to hold the tightly packed decoded image.
+     */
+    size_t
+    outputSize() const;
+
+    /**
+     Starts decoding into caller owned memory which must stay valid until
+     decoding completes or the decoder is closed.
+     @param destination  Start of the bottom row of the destination.
+     @param row_pitch    Byte distance between destination rows, at least
+                         PNGDecoder#outputRowBytes.
+     @return             Boolean indicating success of the operation.
+     */
+    bool
+    begin(void* destination,
+          size_t row_pitch);
+
+    /**
+     Decodes up to the given number of rows. Interlaced images need every row
+     once per pass, so they report progress per row per pass.
+     @return    Boolean false if the image is corrupt.
+     */
+    bool
+    decodeRows(unsigned int max_rows);
+
+    /**
+     Determines if every row has been written to the destination.
+     */
+    bool
+    isComplete() const;
+
+    /**
+     Fraction of the decode that has been completed, in the range [0,1].
+     */
+    float
+    progress() const;
+
+    /**
+     Releases libpng and closes the file, also called by the destructor.
+     */
+    void
+    close();
+
+private:
+
+    PNGDecoder(const PNGDecoder&);
+    PNGDecoder& operator=(const PNGDecoder&);
+
+    bool
+    readHeader();
+
+    static void
+    readMemory(png_struct_def* png_ptr,
+               unsigned char* out,
+               size_t count);
+
+    FILE* fp_;
+    PackageView source_;
+    const unsigned char* memory_;
+    size_t memory_size_;
+    size_t memory_cursor_;
+    png_struct_def* png_ptr_;
+    png_info_def* info_ptr_;
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int native_components_;
+    unsigned int native_bytes_;
+    unsigned int out_components_;
+    unsigned int out_bytes_;
+    unsigned char* destination_;
+    size_t row_pitch_;
+    unsigned int passes_;
+    unsigned int rows_done_;
+    bool failed_;
+};
+
+} // end namespace tygra
+
+#endif
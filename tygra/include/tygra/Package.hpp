@@ -0,0 +1,192 @@
+/**
+ * @file    Package.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_PACKAGE__
+#define __TYGRA_PACKAGE__
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace tygra
+{
+
+/**
+ Read-only view of one package entry. Stored entries point straight into the
+ package mapping, compressed entries own their inflated bytes.
+ @remark    A view into the mapping is only valid while its package is open.
+ */
+class PackageView
+{
+public:
+
+    PackageView();
+
+    PackageView(PackageView&& rhs);
+
+    PackageView&
+    operator=(PackageView&& rhs);
+
+    bool
+    isValid() const;
+
+    /**
+     Determines if the view points into the mapping rather than a copy.
+     */
+    bool
+    isMapped() const;
+
+    const void*
+    data() const;
+
+    size_t
+    size() const;
+
+private:
+
+    friend class Package;
+
+    PackageView(const PackageView&);
+    PackageView& operator=(const PackageView&);
+
+    const unsigned char* data_;
+    size_t size_;
+    std::vector<unsigned char> inflated_;
+};
+
+/**
+ A single file holding many assets behind a sorted table of contents.
+ The file is memory mapped once on open and entries are served as views
+ into the mapping, so loading an asset costs no open or read call.
+ */
+class Package
+{
+public:
+
+    Package();
+
+    ~Package();
+
+    /**
+     Maps the package file and validates its table of contents.
+     @param filepath    A valid path to a package written by PackageBuilder.
+     @return            Boolean indicating success of the operation.
+     */
+    bool
+    open(std::string filepath);
+
+    void
+    close();
+
+    bool
+    isOpen() const;
+
+    /**
+     Number of entries in the package.
+     */
+    unsigned int
+    entryCount() const;
+
+    /**
+     Name of the entry at the given table of contents position.
+     */
+    std::string
+    entryName(unsigned int index) const;
+
+    /**
+     Determines if the package holds an entry with the given name.
+     Names are relative paths using forward slashes, backslashes are accepted.
+     */
+    bool
+    contains(std::string name) const;
+
+    /**
+     Looks up an entry by name.
+     @return    An invalid view if the entry is missing or fails to inflate.
+     */
+    PackageView
+    view(std::string name) const;
+
+private:
+
+    Package(const Package&);
+    Package& operator=(const Package&);
+
+    const void*
+    findEntry(const std::string& name) const;
+
+    void* file_handle_;
+    void* mapping_handle_;
+    const unsigned char* base_;
+    size_t size_;
+    unsigned int entry_count_;
+};
+
+/**
+ Writes a package file from a list of files on disk.
+ */
+class PackageBuilder
+{
+public:
+
+    PackageBuilder();
+
+    /**
+     Byte alignment of every entry within the package, a power of two.
+     */
+    void
+    setAlignment(unsigned int alignment);
+
+    /**
+     Deflates entries when that saves at least an eighth of their size.
+     */
+    void
+    setCompression(bool enabled);
+
+    /**
+     Queues a file to be stored under the given entry name.
+     */
+    void
+    addFile(std::string name,
+            std::string filepath);
+
+    /**
+     Reads every queued file and writes the package.
+     @return    Boolean indicating success of the operation.
+     */
+    bool
+    write(std::string filepath) const;
+
+private:
+
+    struct Source
+    {
+        std::string name;
+        std::string filepath;
+    };
+
+    std::vector<Source> sources_;
+    unsigned int alignment_;
+    bool compress_;
+};
+
+/**
+ Serves subsequent loads through FileHelper and PNGDecoder from the package
+ before falling back to the file system. Mount before any loading starts and
+ keep the package open while mounted, pass nullptr to unmount.
+ */
+void
+mountPackage(const Package* package);
+
+/**
+ The currently mounted package, or nullptr.
+ */
+const Package*
+mountedPackage();
+
+} // end namespace tygra
+
+#endif
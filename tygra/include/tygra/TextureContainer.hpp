@@ -0,0 +1,133 @@
+/**
+ * @file    TextureContainer.hpp
+ * @date    October 2026
+ */
+
+#pragma once
+#ifndef __TYGRA_TEXTURECONTAINER__
+#define __TYGRA_TEXTURECONTAINER__
+
+#include "Package.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace tygra
+{
+
+/**
+ A DDS texture holding a complete mip chain in a GPU-native format, either
+ BC1/BC3 blocks or RGBA8 texels. Levels are handed to glCompressedTexImage2D
+ or glTexImage2D exactly as stored, no pixel processing happens on load.
+ @remark    Rows are stored bottom-up to match glTexImage2D, which is how
+            writeTextureContainer lays them out.
+ */
+class TextureContainer
+{
+public:
+
+    TextureContainer();
+
+    TextureContainer(TextureContainer&& rhs);
+
+    /**
+     Opens a DDS file, served from the mounted package when it holds an
+     entry with the same name.
+     @return    Boolean false if missing or in an unsupported format.
+     */
+    bool
+    open(std::string filepath);
+
+    void
+    close();
+
+    bool
+    isOpen() const;
+
+    /**
+     Determines if the levels are compressed blocks, upload those with
+     glCompressedTexImage2D.
+     */
+    bool
+    isCompressed() const;
+
+    /**
+     Bytes per 4x4 block of compressed levels, zero when uncompressed.
+     */
+    unsigned int
+    blockBytes() const;
+
+    /**
+     GL internal format to create the texture with. Compressed formats need
+     EXT_texture_compression_s3tc, check with tglIsAvailable before upload.
+     */
+    unsigned int
+    glInternalFormat() const;
+
+    /**
+     GL pixel format and type of uncompressed levels, zero when compressed.
+     */
+    unsigned int
+    glFormat() const;
+
+    unsigned int
+    glType() const;
+
+    unsigned int
+    width() const;
+
+    unsigned int
+    height() const;
+
+    unsigned int
+    levelCount() const;
+
+    unsigned int
+    levelWidth(unsigned int level) const;
+
+    unsigned int
+    levelHeight(unsigned int level) const;
+
+    const void*
+    levelData(unsigned int level) const;
+
+    size_t
+    levelSize(unsigned int level) const;
+
+private:
+
+    TextureContainer(const TextureContainer&);
+    TextureContainer& operator=(const TextureContainer&);
+
+    PackageView source_;
+    std::vector<unsigned char> file_data_;
+    const unsigned char* data_;
+    size_t size_;
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int internal_format_;
+    unsigned int block_bytes_;
+    bool bgra_;
+    std::vector<size_t> level_offsets_;
+};
+
+/**
+ Path of the container that replaces a PNG when present, the same path with
+ a .dds extension.
+ */
+std::string
+containerPathForPNG(std::string png_filepath);
+
+/**
+ Converts a PNG into a DDS with a full box filtered mip chain.
+ @param compress    BC1, or BC3 when the image has alpha, else RGBA8.
+ @return            Boolean indicating success of the operation.
+ */
+bool
+writeTextureContainer(std::string png_filepath,
+                      std::string dds_filepath,
+                      bool compress);
+
+} // end namespace tygra
+
+#endif
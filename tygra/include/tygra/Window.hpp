@@ -8,18 +8,26 @@
 #ifndef __TYGRA_WINDOW__
 #define __TYGRA_WINDOW__
 
+#include <deque>
+#include <tygra/FrameScheduler.hpp>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
-// forward declare GLFW type to avoid #include polution
+// forward declare GLFW and GL types to avoid #include polution
 typedef struct GLFWwindow GLFWwindow;
+typedef struct __GLsync *GLsync;
 
 namespace tygra
 {
 
 class WindowViewDelegate;
 class WindowControlDelegate;
+class CommandQueue;
 
 /**
  Provides an OpenGL compatible rendering window for use with
@@ -79,6 +87,77 @@ public:
          int major_version = 3,
          int minor_version = 3);
 
+    /**
+     Chooses whether the view renders on a thread of its own, which owns
+     the GL context once the window has opened. The thread calling
+     Window#update then only runs the controller and polls events, handing
+     each frame over through a bounded queue, so a slow swap or a vsync
+     wait no longer holds up input. Every view delegate method is called on
+     the render thread, every control delegate method on this one.
+     This call is only valid before the window is open.
+     */
+    void
+    setRenderThread(bool yes);
+
+    bool
+    hasRenderThread() const;
+
+    /**
+     Runs work on the thread that owns the GL context: queued behind the
+     frames already waiting when there is a render thread, otherwise
+     straight away. Control delegates use it to reach the view.
+     @param work    The work to run.
+     @param wait    Boolean indicating the call should only return once the
+                    work has run.
+     */
+    void
+    runOnRenderThread(std::function<void()> work,
+                      bool wait = false);
+
+    /**
+     Chooses whether buffers and textures are created on a thread of their
+     own, with a hidden GL context sharing objects with the window's, so
+     loading and streaming no longer stall the frames being drawn.
+     This call is only valid before the window is open.
+     */
+    void
+    setUploadThread(bool yes);
+
+    bool
+    hasUploadThread() const;
+
+    /**
+     Runs GL work on the upload thread then, once the GPU has finished it,
+     calls ready on the thread that owns the window's context at the start
+     of a frame. The objects the work creates are safe to use from ready
+     on. Vertex arrays and framebuffers are not shared between contexts so
+     they belong in ready. Every ready is called, the outstanding ones
+     before the view stops, so ready must cope with a stopped view.
+     Without an upload thread both run straight away.
+     This call is only valid from the thread that owns the window's context.
+     @param work    GL work, touching nothing but what it captures.
+     @param ready   Called once the work's objects are ready, may be empty.
+     */
+    void
+    upload(std::function<void()> work,
+           std::function<void()> ready);
+
+    /**
+     The scheduler deciding when Window#update draws a frame. Its mode and
+     rate may change at any time, the swap interval follows from the next
+     frame on.
+     */
+    FrameScheduler&
+    frameScheduler();
+
+    /**
+     Asks for a frame when the scheduler only draws on demand, waking
+     Window#update if it is waiting for events. Input asks by itself, the
+     application asks when its scene changes. Safe from any thread.
+     */
+    void
+    requestFrame();
+
     /**
      Determines if the operating system window is open.
      */
@@ -88,6 +167,12 @@ public:
     /**
      Performs a window redraw using the view delegate and dequeues any
      operating system events sending them to the control delegate.
+     The frame scheduler may first wait for the frame to be due, or in on
+     demand mode skip the redraw and wait for events instead.
+     With a render thread the redraw is queued instead, or skipped if
+     the queue stays full for longer than a short wait.
+     An exception thrown by the view on the render thread is thrown on
+     from the next call.
      This method must be called regularly, usually within the runloop.
      This call is only valid once the window is open.
      */
@@ -100,6 +185,15 @@ public:
     void
     close();
 
+    /**
+     Asks for the window to stop as if the user had closed it. The
+     delegates are told and the window hidden at the end of the current
+     update, so it is safe to call from within a delegate method.
+     This call is only valid once the window is open.
+     */
+    void
+    requestClose();
+
     /**
      Assign a title to the window (if not fullscreen).
      This call is only valid once the window is open.
@@ -127,6 +221,43 @@ private:
 
     GLFWwindow* glfw_handle_;
 
+    void
+    renderFrame();
+
+    void
+    renderLoop();
+
+    void
+    stopRenderThread();
+
+    void
+    keepThreadError(std::exception_ptr error);
+
+    void
+    rethrowThreadError();
+
+    void
+    uploadLoop();
+
+    void
+    stopUploadThread();
+
+    /**
+     Hands the uploads the GPU has finished to their ready callbacks.
+     @param wait    Wait for every finished upload rather than stopping at
+                    the first the GPU is still busy with.
+     */
+    void
+    pollUploads(bool wait = false);
+
+    /**
+     Waits for every upload queued so far and calls its ready callback, so
+     nothing is left behind when a view stops.
+     Must be called from the thread the view's context is current on.
+     */
+    void
+    finishUploads();
+
     static void
     fakeResizeCallback();
 
@@ -184,6 +315,34 @@ private:
     static GamepadState gamepad_state_[MAX_GAMEPADS];
     std::shared_ptr<WindowViewDelegate> view_;
     std::shared_ptr<WindowControlDelegate> controller_;
+
+    // frames and other GL work for the render thread, if there is one
+    bool use_render_thread_;
+    std::thread render_thread_;
+    std::unique_ptr<CommandQueue> render_queue_;
+    static const int MAX_QUEUED_COMMANDS = 2;
+    // the first exception one of the window's threads caught, for update()
+    std::mutex thread_error_mutex_;
+    std::exception_ptr thread_error_;
+
+    FrameScheduler frame_scheduler_;
+    // the interval last given to glfwSwapInterval, only on the GL thread
+    int swap_interval_;
+
+    // uploads for the upload thread, and the fences of the finished ones
+    // waiting in order for the GPU
+    struct FinishedUpload
+    {
+        GLsync fence;
+        std::function<void()> ready;
+    };
+    bool use_upload_thread_;
+    GLFWwindow* upload_handle_;
+    std::thread upload_thread_;
+    std::unique_ptr<CommandQueue> upload_queue_;
+    std::mutex finished_uploads_mutex_;
+    std::deque<FinishedUpload> finished_uploads_;
+    static const int MAX_QUEUED_UPLOADS = 256;
 };
 
 } // end namespace tygra
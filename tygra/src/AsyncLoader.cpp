@@ -0,0 +1,229 @@
+/**
+ * @file    AsyncLoader.cpp
+ * @date    October 2026
+ */
+
+#include <tygra/AsyncLoader.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace tygra
+{
+
+AsyncLoader::
+AsyncLoader(unsigned int worker_count) : finished_count_(0),
+                                         stop_(false),
+                                         dispatched_count_(0)
+{
+    if (worker_count == 0) {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = std::max(1u, hardware > 1 ? hardware - 1 : 1);
+    }
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers_.push_back(std::thread(&AsyncLoader::workerLoop, this));
+    }
+}
+
+AsyncLoader::
+AsyncLoader(Executor executor) : finished_count_(0),
+                                 stop_(false),
+                                 executor_(std::move(executor)),
+                                 dispatched_count_(0)
+{
+    assert(executor_ != nullptr);
+}
+
+AsyncLoader::
+~AsyncLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    worker_wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+
+    // the executor still holds tasks that point back at this loader
+    std::unique_lock<std::mutex> lock(mutex_);
+    main_wake_.wait(lock, [this] { return dispatched_count_ == 0; });
+}
+
+AsyncLoader::TaskId AsyncLoader::
+addTask(Thread thread,
+        std::function<void()> work,
+        const std::vector<TaskId>& dependencies)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const TaskId id = (TaskId)tasks_.size();
+    Task task;
+    task.thread = thread;
+    task.work = std::move(work);
+    task.waiting_count = 0;
+    task.finished = false;
+    tasks_.push_back(std::move(task));
+
+    for (TaskId dependency : dependencies) {
+        assert(dependency >= 0 && dependency < id);
+        if (!tasks_[dependency].finished) {
+            tasks_[dependency].dependents.push_back(id);
+            tasks_[id].waiting_count++;
+        }
+    }
+    if (tasks_[id].waiting_count == 0) {
+        makeReady(id);
+    }
+    return id;
+}
+
+bool AsyncLoader::
+pump(double seconds)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    for (;;) {
+        TaskId id = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error_ != nullptr) {
+                std::rethrow_exception(error_);
+            }
+            if (!main_ready_.empty()) {
+                id = main_ready_.front();
+                main_ready_.pop_front();
+            }
+        }
+        if (id < 0) {
+            break;
+        }
+        runTask(id);
+
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        if (elapsed.count() >= seconds) {
+            break;
+        }
+    }
+    return isComplete();
+}
+
+void AsyncLoader::
+wait()
+{
+    while (!pump(1.0)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        main_wake_.wait(lock, [this] {
+            return !main_ready_.empty() || error_ != nullptr
+                   || finished_count_ == (int)tasks_.size();
+        });
+    }
+}
+
+bool AsyncLoader::
+isComplete() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finished_count_ == (int)tasks_.size();
+}
+
+float AsyncLoader::
+progress() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.empty() ? 1.f : finished_count_ / (float)tasks_.size();
+}
+
+void AsyncLoader::
+workerLoop()
+{
+    for (;;) {
+        TaskId id = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            worker_wake_.wait(lock, [this] {
+                return stop_ || !worker_ready_.empty();
+            });
+            if (stop_) {
+                return;
+            }
+            id = worker_ready_.front();
+            worker_ready_.pop_front();
+        }
+        runTask(id);
+    }
+}
+
+void AsyncLoader::
+runTask(TaskId id)
+{
+    std::function<void()> work;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        work.swap(tasks_[id].work);
+    }
+
+    std::exception_ptr error;
+    try {
+        work();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Task& task = tasks_[id];
+        task.finished = true;
+        finished_count_++;
+        if (error != nullptr) {
+            // stop scheduling, pump reports the first failure
+            if (error_ == nullptr) {
+                error_ = error;
+            }
+            worker_ready_.clear();
+            main_ready_.clear();
+        } else if (error_ == nullptr) {
+            for (TaskId dependent : task.dependents) {
+                if (--tasks_[dependent].waiting_count == 0) {
+                    makeReady(dependent);
+                }
+            }
+        }
+    }
+    main_wake_.notify_one();
+}
+
+void AsyncLoader::
+runDispatched(TaskId id)
+{
+    bool skip;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        skip = stop_ || error_ != nullptr;
+    }
+    if (!skip) {
+        runTask(id);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    dispatched_count_--;
+    main_wake_.notify_all();
+}
+
+void AsyncLoader::
+makeReady(TaskId id)
+{
+    if (tasks_[id].thread == kWorkerThread && executor_ != nullptr) {
+        dispatched_count_++;
+        executor_([this, id] { runDispatched(id); });
+    } else if (tasks_[id].thread == kWorkerThread) {
+        worker_ready_.push_back(id);
+        worker_wake_.notify_one();
+    } else {
+        main_ready_.push_back(id);
+        main_wake_.notify_one();
+    }
+}
+
+} // end namespace tygra
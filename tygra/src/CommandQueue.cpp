@@ -0,0 +1,65 @@
+/**
+ * @file    CommandQueue.cpp
+ * @date    October 2026
+ */
+
+#include <tygra/CommandQueue.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace tygra
+{
+
+CommandQueue::
+CommandQueue(size_t capacity) : capacity_(std::max(capacity, (size_t)1))
+{
+}
+
+void CommandQueue::
+push(Command command)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return commands_.size() < capacity_; });
+        commands_.push_back(std::move(command));
+    }
+    not_empty_.notify_one();
+}
+
+bool CommandQueue::
+waitForRoom(double seconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return not_full_.wait_for(lock,
+                              std::chrono::duration<double>(seconds),
+                              [this] { return commands_.size() < capacity_; });
+}
+
+CommandQueue::Command CommandQueue::
+pop()
+{
+    Command command;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !commands_.empty(); });
+        command = std::move(commands_.front());
+        commands_.pop_front();
+    }
+    not_full_.notify_all();
+    return command;
+}
+
+size_t CommandQueue::
+size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_.size();
+}
+
+size_t CommandQueue::
+capacity() const
+{
+    return capacity_;
+}
+
+} // end namespace tygra
@@ -0,0 +1,218 @@
+/**
+ * @file    FrameScheduler.cpp
+ * @date    October 2026
+ */
+
+#include <tygra/FrameScheduler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <mmsystem.h>
+#endif
+
+namespace tygra
+{
+
+namespace
+{
+
+const double DEFAULT_RATE = 60; // frames per second
+const double MIN_SLEEP_SLACK = 0.001; // seconds
+const double MAX_SLEEP_SLACK = 0.25; // of the period
+
+// Windows wakes sleeping threads on the system timer tick, 15.6ms unless
+// someone asks for better, which would leave nothing of a frame to sleep
+void
+fineSleeps(bool yes)
+{
+#ifdef _WIN32
+    if (yes) {
+        timeBeginPeriod(1);
+    } else {
+        timeEndPeriod(1);
+    }
+#endif
+}
+
+#ifdef _WIN32
+double
+counterPeriod()
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return 1.0 / frequency.QuadPart;
+}
+
+// read once at startup, the frequency is fixed while the system runs
+const double COUNTER_PERIOD = counterPeriod();
+#endif
+
+} // end anonymous namespace
+
+FrameScheduler::
+FrameScheduler() : mode_(kAdaptiveVsync),
+                   period_(1 / DEFAULT_RATE),
+                   requested_(true),
+                   next_due_(0),
+                   sleep_slack_(MIN_SLEEP_SLACK),
+                   last_frame_(0)
+{
+    resetStats();
+}
+
+FrameScheduler::
+~FrameScheduler()
+{
+    if (mode() == kFixedRate) {
+        fineSleeps(false);
+    }
+}
+
+void FrameScheduler::
+setMode(Mode mode)
+{
+    // the finer timer costs power system wide, only fixed rate sleeps
+    const Mode previous = (Mode)mode_.exchange(mode);
+    if (previous != kFixedRate && mode == kFixedRate) {
+        fineSleeps(true);
+    } else if (previous == kFixedRate && mode != kFixedRate) {
+        fineSleeps(false);
+    }
+    next_due_ = 0;
+    // whatever the new mode, the first frame in it is drawn
+    requested_ = true;
+}
+
+FrameScheduler::Mode FrameScheduler::
+mode() const
+{
+    return (Mode)mode_.load();
+}
+
+void FrameScheduler::
+setTargetRate(double frames_per_second)
+{
+    period_ = 1 / std::max(frames_per_second, 1.0);
+    next_due_ = 0;
+}
+
+double FrameScheduler::
+targetRate() const
+{
+    return 1 / period_;
+}
+
+int FrameScheduler::
+swapInterval() const
+{
+    switch (mode()) {
+    case kAdaptiveVsync:
+        return -1;
+    case kOnDemand:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+void FrameScheduler::
+requestFrame()
+{
+    requested_ = true;
+}
+
+bool FrameScheduler::
+takeRequest()
+{
+    return requested_.exchange(false);
+}
+
+void FrameScheduler::
+waitUntilDue()
+{
+    if (mode() != kFixedRate) {
+        return;
+    }
+    const double start = now();
+    if (next_due_ == 0 || start - next_due_ > period_) {
+        next_due_ = start;
+    }
+
+    // sleeping wakes up late by anything up to a scheduler tick, so only
+    // the part of the wait that is safe to oversleep is slept
+    const double sleep_seconds = next_due_ - start - sleep_slack_;
+    if (sleep_seconds > 0) {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds((long long)(sleep_seconds * 1e6)));
+        // follow late wake ups straight away, early ones slowly, but never
+        // so far that the wait turns into a spin for most of the frame
+        const double late = now() - start - sleep_seconds;
+        sleep_slack_ = std::max(std::max(late, sleep_slack_ * 0.95),
+                                MIN_SLEEP_SLACK);
+        sleep_slack_ = std::min(sleep_slack_, period_ * MAX_SLEEP_SLACK);
+    }
+    while (now() < next_due_) {
+        std::this_thread::yield();
+    }
+    next_due_ += period_;
+}
+
+void FrameScheduler::
+frameFinished()
+{
+    const double finished = now();
+    if (last_frame_ != 0) {
+        const double interval = finished - last_frame_;
+        frames_++;
+        const double delta = interval - mean_;
+        mean_ += delta / frames_;
+        squares_ += delta * (interval - mean_);
+        shortest_ = frames_ == 1 ? interval : std::min(shortest_, interval);
+        longest_ = std::max(longest_, interval);
+    }
+    last_frame_ = finished;
+}
+
+FrameScheduler::Stats FrameScheduler::
+getStats() const
+{
+    Stats stats;
+    stats.frames = frames_;
+    stats.mean_seconds = mean_;
+    stats.variance = frames_ > 1 ? squares_ / (frames_ - 1) : 0;
+    stats.shortest_seconds = shortest_;
+    stats.longest_seconds = longest_;
+    return stats;
+}
+
+void FrameScheduler::
+resetStats()
+{
+    frames_ = 0;
+    mean_ = 0;
+    squares_ = 0;
+    shortest_ = 0;
+    longest_ = 0;
+}
+
+double FrameScheduler::
+now()
+{
+#ifdef _WIN32
+    // the performance counter rather than std::chrono, whose steady_clock
+    // only ticks with the system clock in VS2013
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * COUNTER_PERIOD;
+#else
+    const std::chrono::duration<double> since_epoch
+        = std::chrono::steady_clock::now().time_since_epoch();
+    return since_epoch.count();
+#endif
+}
+
+} // end namespace tygra
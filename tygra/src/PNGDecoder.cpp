@@ -0,0 +1,342 @@
+/**
+ * @file    PNGDecoder.cpp
+ * @date    October 2026
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <tygra/PNGDecoder.hpp>
+#include <png/png.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace tygra
+{
+
+PNGDecoder::
+PNGDecoder() : fp_(nullptr),
+               memory_(nullptr),
+               memory_size_(0),
+               memory_cursor_(0),
+               png_ptr_(nullptr),
+               info_ptr_(nullptr),
+               width_(0),
+               height_(0),
+               native_components_(0),
+               native_bytes_(0),
+               out_components_(0),
+               out_bytes_(0),
+               destination_(nullptr),
+               row_pitch_(0),
+               passes_(1),
+               rows_done_(0),
+               failed_(false)
+{
+}
+
+PNGDecoder::
+~PNGDecoder()
+{
+    close();
+}
+
+bool PNGDecoder::
+open(std::string filepath)
+{
+    close();
+
+    const Package* package = mountedPackage();
+    if (package != nullptr && package->contains(filepath)) {
+        source_ = package->view(filepath);
+        if (!source_.isValid()) {
+            return false;
+        }
+        memory_ = (const unsigned char*)source_.data();
+        memory_size_ = source_.size();
+        return readHeader();
+    }
+
+    fp_ = fopen(filepath.c_str(), "rb");
+    if (fp_ == nullptr) {
+        return false;
+    }
+    return readHeader();
+}
+
+bool PNGDecoder::
+open(const void* data,
+     size_t size)
+{
+    close();
+
+    if (data == nullptr) {
+        return false;
+    }
+    memory_ = (const unsigned char*)data;
+    memory_size_ = size;
+    return readHeader();
+}
+
+bool PNGDecoder::
+readHeader()
+{
+    const int header_size = 8;
+    png_byte header[header_size];
+    if (fp_ != nullptr) {
+        if (fread(header, 1, header_size, fp_) != header_size) {
+            close();
+            return false;
+        }
+    } else {
+        if (memory_size_ < header_size) {
+            close();
+            return false;
+        }
+        memcpy(header, memory_, header_size);
+        memory_cursor_ = header_size;
+    }
+    if (png_sig_cmp(header, 0, header_size) != 0) {
+        close();
+        return false;
+    }
+
+    png_ptr_ = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr);
+    if (png_ptr_ == nullptr) {
+        close();
+        return false;
+    }
+
+    info_ptr_ = png_create_info_struct(png_ptr_);
+    if (info_ptr_ == nullptr) {
+        close();
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr_))) {
+        close();
+        return false;
+    }
+
+    if (fp_ != nullptr) {
+        png_init_io(png_ptr_, fp_);
+    } else {
+        png_set_read_fn(png_ptr_, this, &PNGDecoder::readMemory);
+    }
+    png_set_sig_bytes(png_ptr_, header_size);
+    png_read_info(png_ptr_, info_ptr_);
+
+    width_ = png_get_image_width(png_ptr_, info_ptr_);
+    height_ = png_get_image_height(png_ptr_, info_ptr_);
+    native_bytes_ = png_get_bit_depth(png_ptr_, info_ptr_) == 16 ? 2 : 1;
+
+    const bool has_trns = png_get_valid(png_ptr_, info_ptr_, PNG_INFO_tRNS) != 0;
+    switch (png_get_color_type(png_ptr_, info_ptr_)) {
+    case PNG_COLOR_TYPE_GRAY:
+        native_components_ = has_trns ? 2 : 1;
+        break;
+    case PNG_COLOR_TYPE_GRAY_ALPHA:
+        native_components_ = 2;
+        break;
+    case PNG_COLOR_TYPE_PALETTE:
+    case PNG_COLOR_TYPE_RGB:
+        native_components_ = has_trns ? 4 : 3;
+        break;
+    default:
+        native_components_ = 4;
+        break;
+    }
+
+    out_components_ = native_components_;
+    out_bytes_ = native_bytes_;
+    return true;
+}
+
+unsigned int PNGDecoder::
+width() const
+{
+    return width_;
+}
+
+unsigned int PNGDecoder::
+height() const
+{
+    return height_;
+}
+
+unsigned int PNGDecoder::
+nativeComponentsPerPixel() const
+{
+    return native_components_;
+}
+
+unsigned int PNGDecoder::
+nativeBytesPerComponent() const
+{
+    return native_bytes_;
+}
+
+void PNGDecoder::
+setOutputFormat(unsigned int components_per_pixel,
+                unsigned int bytes_per_component)
+{
+    assert(destination_ == nullptr);
+    assert(components_per_pixel >= 1 && components_per_pixel <= 4);
+    assert(bytes_per_component == 1 || bytes_per_component == 2);
+    out_components_ = components_per_pixel;
+    out_bytes_ = bytes_per_component;
+}
+
+size_t PNGDecoder::
+outputRowBytes() const
+{
+    return (size_t)width_ * out_components_ * out_bytes_;
+}
+
+size_t PNGDecoder::
+outputSize() const
+{
+    return outputRowBytes() * height_;
+}
+
+bool PNGDecoder::
+begin(void* destination,
+      size_t row_pitch)
+{
+    if (png_ptr_ == nullptr || destination == nullptr
+        || row_pitch < outputRowBytes()) {
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr_))) {
+        failed_ = true;
+        return false;
+    }
+
+    // palette to RGB, low bit depth grey to 8 bits, tRNS to alpha
+    png_set_expand(png_ptr_);
+    png_set_packing(png_ptr_);
+
+    if (native_bytes_ == 2 && out_bytes_ == 1) {
+        png_set_scale_16(png_ptr_);
+    } else if (native_bytes_ == 1 && out_bytes_ == 2) {
+        png_set_expand_16(png_ptr_);
+    }
+    if (out_bytes_ == 2) {
+        png_set_swap(png_ptr_);
+    }
+
+    const bool native_colour = native_components_ >= 3;
+    const bool native_alpha = native_components_ == 2
+                              || native_components_ == 4;
+    const bool out_colour = out_components_ >= 3;
+    const bool out_alpha = out_components_ == 2 || out_components_ == 4;
+    if (native_colour && !out_colour) {
+        png_set_rgb_to_gray_fixed(png_ptr_, 1, -1, -1);
+    } else if (!native_colour && out_colour) {
+        png_set_gray_to_rgb(png_ptr_);
+    }
+    if (native_alpha && !out_alpha) {
+        png_set_strip_alpha(png_ptr_);
+    } else if (!native_alpha && out_alpha) {
+        png_set_add_alpha(png_ptr_, 0xffff, PNG_FILLER_AFTER);
+    }
+
+    passes_ = png_set_interlace_handling(png_ptr_);
+    png_read_update_info(png_ptr_, info_ptr_);
+
+    if (png_get_rowbytes(png_ptr_, info_ptr_) != outputRowBytes()) {
+        failed_ = true;
+        return false;
+    }
+
+    destination_ = (unsigned char*)destination;
+    row_pitch_ = row_pitch;
+    rows_done_ = 0;
+    return true;
+}
+
+bool PNGDecoder::
+decodeRows(unsigned int max_rows)
+{
+    if (failed_ || destination_ == nullptr) {
+        return false;
+    }
+
+    const unsigned int total_rows = height_ * passes_;
+    const unsigned int end_row = std::min(total_rows, rows_done_ + max_rows);
+
+    if (setjmp(png_jmpbuf(png_ptr_))) {
+        failed_ = true;
+        return false;
+    }
+
+    // interlaced images revisit every row once per pass, libpng merges each
+    // pass into the pixels already in the destination row
+    while (rows_done_ < end_row) {
+        const unsigned int y = rows_done_ % height_;
+        png_read_row(png_ptr_,
+                     destination_ + (height_ - y - 1) * row_pitch_,
+                     nullptr);
+        ++rows_done_;
+    }
+    return true;
+}
+
+bool PNGDecoder::
+isComplete() const
+{
+    return destination_ != nullptr && rows_done_ == height_ * passes_;
+}
+
+float PNGDecoder::
+progress() const
+{
+    if (destination_ == nullptr || height_ == 0) {
+        return 0.f;
+    }
+    return rows_done_ / (float)(height_ * passes_);
+}
+
+void PNGDecoder::
+close()
+{
+    if (png_ptr_ != nullptr) {
+        png_destroy_read_struct(&png_ptr_,
+                                info_ptr_ != nullptr ? &info_ptr_ : nullptr,
+                                nullptr);
+    }
+    if (fp_ != nullptr) {
+        fclose(fp_);
+    }
+    fp_ = nullptr;
+    source_ = PackageView();
+    memory_ = nullptr;
+    memory_size_ = 0;
+    memory_cursor_ = 0;
+    png_ptr_ = nullptr;
+    info_ptr_ = nullptr;
+    destination_ = nullptr;
+    row_pitch_ = 0;
+    passes_ = 1;
+    rows_done_ = 0;
+    failed_ = false;
+}
+
+void PNGDecoder::
+readMemory(png_struct_def* png_ptr,
+           unsigned char* out,
+           size_t count)
+{
+    PNGDecoder* decoder = (PNGDecoder*)png_get_io_ptr(png_ptr);
+    if (count > decoder->memory_size_ - decoder->memory_cursor_) {
+        png_error(png_ptr, "Read past the end of the PNG data");
+    }
+    memcpy(out, decoder->memory_ + decoder->memory_cursor_, count);
+    decoder->memory_cursor_ += count;
+}
+
+} // end namespace tygra
@@ -0,0 +1,464 @@
+/**
+ * @file    Package.cpp
+ * @date    October 2026
+ */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <tygra/Package.hpp>
+#include <zlib/zlib.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tygra
+{
+
+/*
+ Package layout, all values little-endian:
+   FileHeader
+   FileEntry[entry_count]    sorted by name
+   char[names_size]          entry names, not null terminated
+   entry data                each entry starts on the package alignment
+ */
+
+static const char kPackageMagic[4] = { 'T', 'P', 'A', 'K' };
+static const uint32_t kPackageVersion = 1;
+static const uint32_t kEntryDeflated = 1;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t alignment;
+    uint64_t toc_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+};
+
+struct FileEntry
+{
+    uint64_t offset;
+    uint64_t stored_size;
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static const Package* g_mounted_package = nullptr;
+
+static std::string
+normalisedName(std::string name)
+{
+    std::replace(name.begin(), name.end(), '\\', '/');
+    while (name.compare(0, 2, "./") == 0) {
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+PackageView::
+PackageView() : data_(nullptr),
+                size_(0)
+{
+}
+
+PackageView::
+PackageView(PackageView&& rhs)
+{
+    *this = std::move(rhs);
+}
+
+PackageView& PackageView::
+operator=(PackageView&& rhs)
+{
+    // moving the vector keeps its buffer so an inflated data_ stays valid
+    inflated_ = std::move(rhs.inflated_);
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+    return *this;
+}
+
+bool PackageView::
+isValid() const
+{
+    return data_ != nullptr;
+}
+
+bool PackageView::
+isMapped() const
+{
+    return inflated_.empty() || data_ != inflated_.data();
+}
+
+const void* PackageView::
+data() const
+{
+    return data_;
+}
+
+size_t PackageView::
+size() const
+{
+    return size_;
+}
+
+Package::
+Package() : file_handle_(nullptr),
+            mapping_handle_(nullptr),
+            base_(nullptr),
+            size_(0),
+            entry_count_(0)
+{
+}
+
+Package::
+~Package()
+{
+    close();
+}
+
+bool Package::
+open(std::string filepath)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    size_ = (size_t)file_size.QuadPart;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                        0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mapping_handle_ = mapping;
+
+    base_ = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ,
+                                                0, 0, 0);
+#else
+    const int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = (size_t)file_stat.st_size;
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    base_ = mapping != MAP_FAILED ? (const unsigned char*)mapping : nullptr;
+#endif
+    if (base_ == nullptr) {
+        close();
+        return false;
+    }
+
+    // validate the table of contents once so lookups can trust it
+    if (size_ < sizeof(FileHeader)) {
+        close();
+        return false;
+    }
+    const FileHeader* header = (const FileHeader*)base_;
+    const uint64_t toc_end = header->toc_offset
+                             + (uint64_t)header->entry_count * sizeof(FileEntry);
+    if (memcmp(header->magic, kPackageMagic, sizeof(kPackageMagic)) != 0
+        || header->version != kPackageVersion
+        || toc_end > size_
+        || header->names_offset + header->names_size > size_) {
+        close();
+        return false;
+    }
+    const FileEntry* toc = (const FileEntry*)(base_ + header->toc_offset);
+    for (uint32_t i = 0; i < header->entry_count; ++i) {
+        if (toc[i].offset + toc[i].stored_size > size_
+            || (uint64_t)toc[i].name_offset + toc[i].name_length
+               > header->names_size) {
+            close();
+            return false;
+        }
+    }
+    entry_count_ = header->entry_count;
+    return true;
+}
+
+void Package::
+close()
+{
+#ifdef _WIN32
+    if (base_ != nullptr) {
+        UnmapViewOfFile(base_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(file_handle_);
+    }
+#else
+    if (base_ != nullptr) {
+        munmap((void*)base_, size_);
+    }
+#endif
+    file_handle_ = nullptr;
+    mapping_handle_ = nullptr;
+    base_ = nullptr;
+    size_ = 0;
+    entry_count_ = 0;
+}
+
+bool Package::
+isOpen() const
+{
+    return base_ != nullptr;
+}
+
+unsigned int Package::
+entryCount() const
+{
+    return entry_count_;
+}
+
+std::string Package::
+entryName(unsigned int index) const
+{
+    if (index >= entry_count_) {
+        return "";
+    }
+    const FileHeader* header = (const FileHeader*)base_;
+    const FileEntry& entry
+        = ((const FileEntry*)(base_ + header->toc_offset))[index];
+    const char* names = (const char*)(base_ + header->names_offset);
+    return std::string(names + entry.name_offset, entry.name_length);
+}
+
+bool Package::
+contains(std::string name) const
+{
+    return findEntry(normalisedName(name)) != nullptr;
+}
+
+PackageView Package::
+view(std::string name) const
+{
+    PackageView result;
+    const FileEntry* entry = (const FileEntry*)findEntry(normalisedName(name));
+    if (entry == nullptr) {
+        return result;
+    }
+
+    const unsigned char* stored = base_ + entry->offset;
+    if ((entry->flags & kEntryDeflated) == 0) {
+        result.data_ = stored;
+        result.size_ = (size_t)entry->size;
+        return result;
+    }
+
+    result.inflated_.resize((size_t)std::max<uint64_t>(entry->size, 1));
+    uLongf inflated_size = (uLongf)entry->size;
+    if (uncompress(result.inflated_.data(), &inflated_size,
+                   stored, (uLong)entry->stored_size) != Z_OK
+        || inflated_size != entry->size) {
+        return PackageView();
+    }
+    result.data_ = result.inflated_.data();
+    result.size_ = (size_t)entry->size;
+    return result;
+}
+
+const void* Package::
+findEntry(const std::string& name) const
+{
+    if (base_ == nullptr) {
+        return nullptr;
+    }
+    const FileHeader* header = (const FileHeader*)base_;
+    const FileEntry* toc = (const FileEntry*)(base_ + header->toc_offset);
+    const char* names = (const char*)(base_ + header->names_offset);
+
+    // entries are sorted by name so a binary search over the mapping works
+    // without building any lookup structure on open
+    unsigned int lo = 0;
+    unsigned int hi = entry_count_;
+    while (lo < hi) {
+        const unsigned int mid = (lo + hi) / 2;
+        const int order = name.compare(0, std::string::npos,
+                                       names + toc[mid].name_offset,
+                                       toc[mid].name_length);
+        if (order == 0) {
+            return &toc[mid];
+        }
+        if (order < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+PackageBuilder::
+PackageBuilder() : alignment_(16),
+                   compress_(false)
+{
+}
+
+void PackageBuilder::
+setAlignment(unsigned int alignment)
+{
+    if (alignment != 0 && (alignment & (alignment - 1)) == 0) {
+        alignment_ = alignment;
+    }
+}
+
+void PackageBuilder::
+setCompression(bool enabled)
+{
+    compress_ = enabled;
+}
+
+void PackageBuilder::
+addFile(std::string name,
+        std::string filepath)
+{
+    Source source;
+    source.name = normalisedName(name);
+    source.filepath = filepath;
+    sources_.push_back(source);
+}
+
+bool PackageBuilder::
+write(std::string filepath) const
+{
+    std::vector<Source> sources = sources_;
+    std::sort(sources.begin(), sources.end(),
+              [](const Source& a, const Source& b) { return a.name < b.name; });
+    for (size_t i = 1; i < sources.size(); ++i) {
+        if (sources[i].name == sources[i - 1].name) {
+            return false;
+        }
+    }
+
+    std::vector<FileEntry> toc(sources.size());
+    std::vector<std::vector<unsigned char>> payloads(sources.size());
+    std::string names;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        std::ifstream fp(sources[i].filepath, std::ifstream::binary);
+        if (fp.is_open() == false) {
+            return false;
+        }
+        std::vector<unsigned char>& payload = payloads[i];
+        payload.assign(std::istreambuf_iterator<char>(fp),
+                       std::istreambuf_iterator<char>());
+
+        FileEntry& entry = toc[i];
+        entry.size = payload.size();
+        entry.flags = 0;
+        entry.reserved = 0;
+        entry.name_offset = (uint32_t)names.size();
+        entry.name_length = (uint32_t)sources[i].name.size();
+        names += sources[i].name;
+
+        if (compress_ && !payload.empty()) {
+            uLongf deflated_size = compressBound((uLong)payload.size());
+            std::vector<unsigned char> deflated(deflated_size);
+            if (compress2(deflated.data(), &deflated_size,
+                          payload.data(), (uLong)payload.size(),
+                          Z_BEST_COMPRESSION) == Z_OK
+                && deflated_size <= payload.size() - payload.size() / 8) {
+                deflated.resize(deflated_size);
+                payload.swap(deflated);
+                entry.flags |= kEntryDeflated;
+            }
+        }
+        entry.stored_size = payload.size();
+    }
+
+    const uint64_t align = alignment_;
+    FileHeader header;
+    memcpy(header.magic, kPackageMagic, sizeof(kPackageMagic));
+    header.version = kPackageVersion;
+    header.entry_count = (uint32_t)toc.size();
+    header.alignment = alignment_;
+    header.toc_offset = sizeof(FileHeader);
+    header.names_offset = header.toc_offset + toc.size() * sizeof(FileEntry);
+    header.names_size = names.size();
+
+    uint64_t offset = header.names_offset + header.names_size;
+    for (auto& entry : toc) {
+        offset = (offset + align - 1) & ~(align - 1);
+        entry.offset = offset;
+        offset += entry.stored_size;
+    }
+
+    std::ofstream fp(filepath, std::ofstream::binary | std::ofstream::trunc);
+    if (fp.is_open() == false) {
+        return false;
+    }
+    fp.write((const char*)&header, sizeof(header));
+    if (!toc.empty()) {
+        fp.write((const char*)toc.data(), toc.size() * sizeof(FileEntry));
+    }
+    fp.write(names.data(), names.size());
+
+    const std::vector<char> padding(alignment_, 0);
+    uint64_t written = header.names_offset + header.names_size;
+    for (size_t i = 0; i < toc.size(); ++i) {
+        fp.write(padding.data(), (std::streamsize)(toc[i].offset - written));
+        if (!payloads[i].empty()) {
+            fp.write((const char*)payloads[i].data(), payloads[i].size());
+        }
+        written = toc[i].offset + toc[i].stored_size;
+    }
+    return fp.good();
+}
+
+void
+mountPackage(const Package* package)
+{
+    g_mounted_package = package;
+}
+
+const Package*
+mountedPackage()
+{
+    return g_mounted_package;
+}
+
+} // end namespace tygra
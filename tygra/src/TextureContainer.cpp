@@ -0,0 +1,576 @@
+/**
+ * @file    TextureContainer.cpp
+ * @date    October 2026
+ */
+
+#include <tygra/TextureContainer.hpp>
+#include <tygra/PNGDecoder.hpp>
+#include <tgl/tgl.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace tygra
+{
+
+/*
+ DDS layout: "DDS " magic, DDSHeader, then every mip level back to back,
+ largest first. Only the legacy header is supported, DX10 extended headers
+ are rejected.
+ */
+
+static const uint32_t kDDSMagic = 0x20534444;
+
+static const uint32_t kDDSDCaps = 0x1;
+static const uint32_t kDDSDHeight = 0x2;
+static const uint32_t kDDSDWidth = 0x4;
+static const uint32_t kDDSDPitch = 0x8;
+static const uint32_t kDDSDPixelFormat = 0x1000;
+static const uint32_t kDDSDMipMapCount = 0x20000;
+static const uint32_t kDDSDLinearSize = 0x80000;
+
+static const uint32_t kDDPFAlphaPixels = 0x1;
+static const uint32_t kDDPFFourCC = 0x4;
+static const uint32_t kDDPFRGB = 0x40;
+
+static const uint32_t kDDSCapsComplex = 0x8;
+static const uint32_t kDDSCapsTexture = 0x1000;
+static const uint32_t kDDSCapsMipMap = 0x400000;
+
+static const uint32_t kFourCCDXT1 = 0x31545844;
+static const uint32_t kFourCCDXT3 = 0x33545844;
+static const uint32_t kFourCCDXT5 = 0x35545844;
+
+struct DDSPixelFormat
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t four_cc;
+    uint32_t rgb_bit_count;
+    uint32_t r_mask;
+    uint32_t g_mask;
+    uint32_t b_mask;
+    uint32_t a_mask;
+};
+
+struct DDSHeader
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitch_or_linear_size;
+    uint32_t depth;
+    uint32_t mip_map_count;
+    uint32_t reserved1[11];
+    DDSPixelFormat pixel_format;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+TextureContainer::
+TextureContainer() : data_(nullptr),
+                     size_(0),
+                     width_(0),
+                     height_(0),
+                     internal_format_(0),
+                     block_bytes_(0),
+                     bgra_(false)
+{
+}
+
+TextureContainer::
+TextureContainer(TextureContainer&& rhs)
+{
+    source_ = std::move(rhs.source_);
+    file_data_ = std::move(rhs.file_data_);
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    width_ = rhs.width_;
+    height_ = rhs.height_;
+    internal_format_ = rhs.internal_format_;
+    block_bytes_ = rhs.block_bytes_;
+    bgra_ = rhs.bgra_;
+    level_offsets_ = std::move(rhs.level_offsets_);
+    rhs.data_ = nullptr;
+    rhs.size_ = 0;
+}
+
+bool TextureContainer::
+open(std::string filepath)
+{
+    close();
+
+    const Package* package = mountedPackage();
+    if (package != nullptr && package->contains(filepath)) {
+        source_ = package->view(filepath);
+        data_ = (const unsigned char*)source_.data();
+        size_ = source_.size();
+    } else {
+        std::ifstream fp(filepath, std::ifstream::binary);
+        if (fp.is_open() == false) {
+            return false;
+        }
+        file_data_.assign(std::istreambuf_iterator<char>(fp),
+                          std::istreambuf_iterator<char>());
+        data_ = file_data_.data();
+        size_ = file_data_.size();
+    }
+
+    if (data_ == nullptr || size_ < sizeof(uint32_t) + sizeof(DDSHeader)) {
+        close();
+        return false;
+    }
+    uint32_t magic;
+    DDSHeader header;
+    memcpy(&magic, data_, sizeof(magic));
+    memcpy(&header, data_ + sizeof(magic), sizeof(header));
+    if (magic != kDDSMagic
+        || header.size != sizeof(DDSHeader)
+        || header.width == 0 || header.height == 0) {
+        close();
+        return false;
+    }
+
+    const DDSPixelFormat& pf = header.pixel_format;
+    if ((pf.flags & kDDPFFourCC) != 0) {
+        switch (pf.four_cc) {
+        case kFourCCDXT1:
+            internal_format_ = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            block_bytes_ = 8;
+            break;
+        case kFourCCDXT3:
+            internal_format_ = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            block_bytes_ = 16;
+            break;
+        case kFourCCDXT5:
+            internal_format_ = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            block_bytes_ = 16;
+            break;
+        default:
+            close();
+            return false;
+        }
+    } else if ((pf.flags & kDDPFRGB) != 0 && pf.rgb_bit_count == 32
+               && pf.g_mask == 0x0000ff00 && pf.a_mask == 0xff000000
+               && (pf.r_mask == 0x000000ff || pf.r_mask == 0x00ff0000)) {
+        internal_format_ = GL_RGBA8;
+        block_bytes_ = 0;
+        bgra_ = pf.r_mask == 0x00ff0000;
+    } else {
+        close();
+        return false;
+    }
+
+    width_ = header.width;
+    height_ = header.height;
+    const unsigned int level_count = (header.flags & kDDSDMipMapCount) != 0
+                                     ? std::max(1u, header.mip_map_count) : 1;
+    size_t offset = sizeof(magic) + sizeof(header);
+    for (unsigned int i = 0; i < level_count; ++i) {
+        level_offsets_.push_back(offset);
+        offset += levelSize(i);
+    }
+    level_offsets_.push_back(offset);
+    if (offset > size_) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TextureContainer::
+close()
+{
+    source_ = PackageView();
+    file_data_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    width_ = 0;
+    height_ = 0;
+    internal_format_ = 0;
+    block_bytes_ = 0;
+    bgra_ = false;
+    level_offsets_.clear();
+}
+
+bool TextureContainer::
+isOpen() const
+{
+    return data_ != nullptr;
+}
+
+bool TextureContainer::
+isCompressed() const
+{
+    return block_bytes_ != 0;
+}
+
+unsigned int TextureContainer::
+blockBytes() const
+{
+    return block_bytes_;
+}
+
+unsigned int TextureContainer::
+glInternalFormat() const
+{
+    return internal_format_;
+}
+
+unsigned int TextureContainer::
+glFormat() const
+{
+    if (isCompressed()) {
+        return 0;
+    }
+    return bgra_ ? GL_BGRA : GL_RGBA;
+}
+
+unsigned int TextureContainer::
+glType() const
+{
+    return isCompressed() ? 0 : GL_UNSIGNED_BYTE;
+}
+
+unsigned int TextureContainer::
+width() const
+{
+    return width_;
+}
+
+unsigned int TextureContainer::
+height() const
+{
+    return height_;
+}
+
+unsigned int TextureContainer::
+levelCount() const
+{
+    return level_offsets_.empty() ? 0 : level_offsets_.size() - 1;
+}
+
+unsigned int TextureContainer::
+levelWidth(unsigned int level) const
+{
+    return std::max(1u, width_ >> level);
+}
+
+unsigned int TextureContainer::
+levelHeight(unsigned int level) const
+{
+    return std::max(1u, height_ >> level);
+}
+
+const void* TextureContainer::
+levelData(unsigned int level) const
+{
+    return data_ + level_offsets_[level];
+}
+
+size_t TextureContainer::
+levelSize(unsigned int level) const
+{
+    const size_t width = levelWidth(level);
+    const size_t height = levelHeight(level);
+    if (block_bytes_ == 0) {
+        return width * height * 4;
+    }
+    return ((width + 3) / 4) * ((height + 3) / 4) * block_bytes_;
+}
+
+std::string
+containerPathForPNG(std::string png_filepath)
+{
+    const size_t dot = png_filepath.find_last_of('.');
+    const size_t slash = png_filepath.find_last_of("/\\");
+    if (dot == std::string::npos
+        || (slash != std::string::npos && dot < slash)) {
+        return png_filepath + ".dds";
+    }
+    return png_filepath.substr(0, dot) + ".dds";
+}
+
+static uint16_t
+packColour565(const int colour[3])
+{
+    return (uint16_t)(((colour[0] >> 3) << 11)
+                      | ((colour[1] >> 2) << 5)
+                      | (colour[2] >> 3));
+}
+
+static void
+unpackColour565(uint16_t packed, int colour[3])
+{
+    const int r = (packed >> 11) & 31;
+    const int g = (packed >> 5) & 63;
+    const int b = packed & 31;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+}
+
+/*
+ Encodes the colour of a 4x4 block of RGBA8 texels as a BC1 block.
+ Endpoints are the corners of the colour bounding box along its dominant
+ diagonal, inset slightly to reduce quantisation error at the extremes.
+ */
+static void
+encodeColourBlock(const unsigned char texels[16][4],
+                  unsigned char out[8])
+{
+    int lo[3] = { 255, 255, 255 };
+    int hi[3] = { 0, 0, 0 };
+    int mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = std::min(lo[c], (int)texels[i][c]);
+            hi[c] = std::max(hi[c], (int)texels[i][c]);
+            mean[c] += texels[i][c];
+        }
+    }
+    int cross_rg = 0;
+    int cross_bg = 0;
+    for (int i = 0; i < 16; ++i) {
+        const int dg = texels[i][1] * 16 - mean[1];
+        cross_rg += (texels[i][0] * 16 - mean[0]) * dg;
+        cross_bg += (texels[i][2] * 16 - mean[2]) * dg;
+    }
+    for (int c = 0; c < 3; ++c) {
+        const int inset = (hi[c] - lo[c]) / 16;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+    if (cross_rg < 0) {
+        std::swap(lo[0], hi[0]);
+    }
+    if (cross_bg < 0) {
+        std::swap(lo[2], hi[2]);
+    }
+
+    uint16_t c0 = packColour565(hi);
+    uint16_t c1 = packColour565(lo);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    int palette[4][3];
+    unpackColour565(c0, palette[0]);
+    unpackColour565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int best_error = INT32_MAX;
+            for (int p = 0; p < 4; ++p) {
+                int error = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int d = texels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    out[0] = (unsigned char)(c0 & 0xff);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xff);
+    out[3] = (unsigned char)(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+/*
+ Encodes the alpha of a 4x4 block of RGBA8 texels as a BC3 alpha block
+ using the eight value mode between the block's minimum and maximum.
+ */
+static void
+encodeAlphaBlock(const unsigned char texels[16][4],
+                 unsigned char out[8])
+{
+    int a0 = 0;
+    int a1 = 255;
+    for (int i = 0; i < 16; ++i) {
+        a0 = std::max(a0, (int)texels[i][3]);
+        a1 = std::min(a1, (int)texels[i][3]);
+    }
+
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        int palette[8] = { a0, a1 };
+        for (int p = 1; p < 7; ++p) {
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int best_error = 256;
+            for (int p = 0; p < 8; ++p) {
+                const int error = std::abs(texels[i][3] - palette[p]);
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+static void
+encodeLevel(const unsigned char* rgba,
+            unsigned int width,
+            unsigned int height,
+            bool with_alpha,
+            std::vector<unsigned char>& out)
+{
+    for (unsigned int by = 0; by < height; by += 4) {
+        for (unsigned int bx = 0; bx < width; bx += 4) {
+            // edge blocks repeat the last row and column
+            unsigned char texels[16][4];
+            for (unsigned int i = 0; i < 16; ++i) {
+                const unsigned int x = std::min(bx + i % 4, width - 1);
+                const unsigned int y = std::min(by + i / 4, height - 1);
+                memcpy(texels[i], rgba + (y * width + x) * 4, 4);
+            }
+            unsigned char block[16];
+            unsigned char* colour = block;
+            if (with_alpha) {
+                encodeAlphaBlock(texels, block);
+                colour = block + 8;
+            }
+            encodeColourBlock(texels, colour);
+            out.insert(out.end(), block, colour + 8);
+        }
+    }
+}
+
+bool
+writeTextureContainer(std::string png_filepath,
+                      std::string dds_filepath,
+                      bool compress)
+{
+    PNGDecoder decoder;
+    if (!decoder.open(png_filepath)) {
+        return false;
+    }
+    decoder.setOutputFormat(4, 1);
+    unsigned int width = decoder.width();
+    unsigned int height = decoder.height();
+    std::vector<unsigned char> level(decoder.outputSize());
+    if (!decoder.begin(level.data(), decoder.outputRowBytes())) {
+        return false;
+    }
+    while (!decoder.isComplete()) {
+        if (!decoder.decodeRows(height)) {
+            return false;
+        }
+    }
+    decoder.close();
+
+    bool with_alpha = false;
+    for (size_t i = 3; i < level.size(); i += 4) {
+        with_alpha = with_alpha || level[i] != 255;
+    }
+
+    unsigned int level_count = 1;
+    while ((std::max(width, height) >> level_count) > 0) {
+        ++level_count;
+    }
+
+    DDSHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DDSHeader);
+    header.flags = kDDSDCaps | kDDSDHeight | kDDSDWidth | kDDSDPixelFormat
+                   | kDDSDMipMapCount | (compress ? kDDSDLinearSize : kDDSDPitch);
+    header.width = width;
+    header.height = height;
+    header.mip_map_count = level_count;
+    header.pixel_format.size = sizeof(DDSPixelFormat);
+    if (compress) {
+        header.pixel_format.flags = kDDPFFourCC;
+        header.pixel_format.four_cc = with_alpha ? kFourCCDXT5 : kFourCCDXT1;
+        header.pitch_or_linear_size = ((width + 3) / 4) * ((height + 3) / 4)
+                                      * (with_alpha ? 16 : 8);
+    } else {
+        header.pixel_format.flags = kDDPFRGB | kDDPFAlphaPixels;
+        header.pixel_format.rgb_bit_count = 32;
+        header.pixel_format.r_mask = 0x000000ff;
+        header.pixel_format.g_mask = 0x0000ff00;
+        header.pixel_format.b_mask = 0x00ff0000;
+        header.pixel_format.a_mask = 0xff000000;
+        header.pitch_or_linear_size = width * 4;
+    }
+    header.caps = kDDSCapsTexture | kDDSCapsMipMap | kDDSCapsComplex;
+
+    std::ofstream fp(dds_filepath, std::ofstream::binary | std::ofstream::trunc);
+    if (fp.is_open() == false) {
+        return false;
+    }
+    fp.write((const char*)&kDDSMagic, sizeof(kDDSMagic));
+    fp.write((const char*)&header, sizeof(header));
+
+    std::vector<unsigned char> blocks;
+    for (unsigned int i = 0; i < level_count; ++i) {
+        if (compress) {
+            blocks.clear();
+            encodeLevel(level.data(), width, height, with_alpha, blocks);
+            fp.write((const char*)blocks.data(), blocks.size());
+        } else {
+            fp.write((const char*)level.data(), level.size());
+        }
+        if (i + 1 == level_count) {
+            break;
+        }
+
+        // box filter the next level, odd edges reuse the last row/column
+        const unsigned int next_width = std::max(1u, width / 2);
+        const unsigned int next_height = std::max(1u, height / 2);
+        std::vector<unsigned char> next(next_width * next_height * 4);
+        for (unsigned int y = 0; y < next_height; ++y) {
+            const unsigned int y0 = std::min(y * 2, height - 1);
+            const unsigned int y1 = std::min(y * 2 + 1, height - 1);
+            for (unsigned int x = 0; x < next_width; ++x) {
+                const unsigned int x0 = std::min(x * 2, width - 1);
+                const unsigned int x1 = std::min(x * 2 + 1, width - 1);
+                for (unsigned int c = 0; c < 4; ++c) {
+                    const unsigned int sum = level[(y0 * width + x0) * 4 + c]
+                                           + level[(y0 * width + x1) * 4 + c]
+                                           + level[(y1 * width + x0) * 4 + c]
+                                           + level[(y1 * width + x1) * 4 + c];
+                    next[(y * next_width + x) * 4 + c]
+                        = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        level.swap(next);
+        width = next_width;
+        height = next_height;
+    }
+    return fp.good();
+}
+
+} // end namespace tygra
@@ -10,13 +10,23 @@
 #include <tygra/Window.hpp>
 #include <tygra/WindowViewDelegate.hpp>
 #include <tygra/WindowControlDelegate.hpp>
+#include <tygra/CommandQueue.hpp>
 #include <tgl/tgl.h>
 #define GLFW_INCLUDE_NONE
 #include <glfw/glfw3.h>
+#include <future>
 
 namespace tygra
 {
 
+namespace
+{
+
+// the longest single wait on an upload's fence, in nanoseconds
+const GLuint64 UPLOAD_WAIT_TIMEOUT = 1000000;
+
+} // end anonymous namespace
+
 std::shared_ptr<Window> Window::main_window_;
 
 Window::GamepadState Window::gamepad_state_[Window::MAX_GAMEPADS];
@@ -42,8 +52,26 @@ setView(std::shared_ptr<WindowViewDelegate> view)
 	if (view == view_) {
 		return;
     }
-    if (isVisible()) {
+    if (isVisible() && render_thread_.joinable()) {
+        // the view's GL work belongs on the render thread, asking for the
+        // size on this one
+        int width, height;
+        glfwGetWindowSize(glfw_handle_, &width, &height);
+        auto self = shared_from_this();
+        runOnRenderThread([this, self, view, width, height] {
+            if (view_ != nullptr) {
+                finishUploads();
+                view_->windowViewDidStop(self);
+            }
+            view_ = view;
+            if (view_ != nullptr) {
+                view_->windowViewWillStart(self);
+                view_->windowViewDidReset(self, width, height);
+            }
+        }, true);
+    } else if (isVisible()) {
 	    if (view_ != nullptr) {
+            finishUploads();
 		    view_->windowViewDidStop(shared_from_this());
 	    }
         view_ = view;
@@ -134,7 +162,8 @@ open(int width,
         return false;
     }
     glfwMakeContextCurrent(glfw_handle_);
-    glfwSwapInterval(-1);
+    swap_interval_ = frame_scheduler_.swapInterval();
+    glfwSwapInterval(swap_interval_);
     glfwShowWindow(glfw_handle_);
 
     tglInit();
@@ -160,9 +189,198 @@ open(int width,
         controller_->windowControlWillStart(shared_from_this());
     }
 
+    // a hidden window whose context shares objects with this one
+    if (use_upload_thread_) {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        upload_handle_ = glfwCreateWindow(1, 1, "TyGrA uploads",
+                                          NULL, glfw_handle_);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+        if (upload_handle_ != nullptr) {
+            upload_queue_.reset(new CommandQueue(MAX_QUEUED_UPLOADS));
+            upload_thread_ = std::thread(&Window::uploadLoop, this);
+        }
+    }
+
+    // everything so far ran here, from now on the context belongs to the
+    // render thread
+    if (use_render_thread_) {
+        glfwMakeContextCurrent(NULL);
+        render_queue_.reset(new CommandQueue(MAX_QUEUED_COMMANDS));
+        render_thread_ = std::thread(&Window::renderLoop, this);
+    }
+
     return true;
 }
 
+void Window::
+setRenderThread(bool yes)
+{
+    use_render_thread_ = yes;
+}
+
+bool Window::
+hasRenderThread() const
+{
+    return use_render_thread_;
+}
+
+void Window::
+runOnRenderThread(std::function<void()> work,
+                  bool wait)
+{
+    if (!render_thread_.joinable()
+        || std::this_thread::get_id() == render_thread_.get_id()) {
+        work();
+        return;
+    }
+    if (!wait) {
+        render_queue_->push(std::move(work));
+        return;
+    }
+    std::promise<void> done;
+    render_queue_->push([&work, &done] {
+        try {
+            work();
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    });
+    // rethrows whatever the work threw
+    done.get_future().get();
+}
+
+void Window::
+setUploadThread(bool yes)
+{
+    use_upload_thread_ = yes;
+}
+
+bool Window::
+hasUploadThread() const
+{
+    return use_upload_thread_;
+}
+
+void Window::
+upload(std::function<void()> work,
+       std::function<void()> ready)
+{
+    if (!upload_thread_.joinable()) {
+        work();
+        if (ready != nullptr) {
+            ready();
+        }
+        return;
+    }
+    upload_queue_->push([this, work, ready] {
+        work();
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // the fence has to reach the GPU before another context waits on it
+        glFlush();
+        FinishedUpload finished = { fence, ready };
+        {
+            std::lock_guard<std::mutex> lock(finished_uploads_mutex_);
+            finished_uploads_.push_back(std::move(finished));
+        }
+        // ready is only called at the start of a frame
+        requestFrame();
+    });
+}
+
+void Window::
+uploadLoop()
+{
+    glfwMakeContextCurrent(upload_handle_);
+    // an empty command asks the thread to stop
+    for (;;) {
+        CommandQueue::Command command = upload_queue_->pop();
+        if (command == nullptr) {
+            break;
+        }
+        try {
+            command();
+        } catch (...) {
+            keepThreadError(std::current_exception());
+        }
+    }
+    glfwMakeContextCurrent(NULL);
+}
+
+void Window::
+pollUploads(bool wait)
+{
+    // in order, stopping at the first the GPU is still busy with
+    for (;;) {
+        FinishedUpload finished;
+        {
+            std::lock_guard<std::mutex> lock(finished_uploads_mutex_);
+            if (finished_uploads_.empty()) {
+                break;
+            }
+            GLenum status;
+            do {
+                status = glClientWaitSync(finished_uploads_.front().fence, 0,
+                                          wait ? UPLOAD_WAIT_TIMEOUT : 0);
+            } while (wait && status == GL_TIMEOUT_EXPIRED);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                break;
+            }
+            finished = std::move(finished_uploads_.front());
+            finished_uploads_.pop_front();
+        }
+        glDeleteSync(finished.fence);
+        // ready may upload again so it runs outside the lock
+        if (finished.ready != nullptr) {
+            finished.ready();
+        }
+    }
+}
+
+void Window::
+finishUploads()
+{
+    if (!upload_thread_.joinable()) {
+        return;
+    }
+    // the marker runs once everything queued before it has been fenced
+    std::promise<void> fenced;
+    upload_queue_->push([&fenced] { fenced.set_value(); });
+    fenced.get_future().wait();
+    pollUploads(true);
+}
+
+void Window::
+stopUploadThread()
+{
+    if (!upload_thread_.joinable()) {
+        return;
+    }
+    upload_queue_->push(CommandQueue::Command());
+    upload_thread_.join();
+    upload_queue_.reset();
+    // the views drained theirs before stopping, anything queued since still
+    // needs its ready to free what it made while the context is alive
+    pollUploads(true);
+    glfwDestroyWindow(upload_handle_);
+    upload_handle_ = nullptr;
+}
+
+FrameScheduler& Window::
+frameScheduler()
+{
+    return frame_scheduler_;
+}
+
+void Window::
+requestFrame()
+{
+    frame_scheduler_.requestFrame();
+    if (glfw_handle_ != nullptr) {
+        glfwPostEmptyEvent();
+    }
+}
+
 bool Window::
 isVisible() const
 {
@@ -175,23 +393,125 @@ update()
     if (isVisible() == false) {
         return;
     }
-    if (view_ != nullptr) {
-        if (controller_ != nullptr) {
+    rethrowThreadError();
+    // on demand nothing is drawn until something asks, meanwhile the thread
+    // sleeps on the event queue with an eye on the gamepads
+    bool draw = true;
+    if (frame_scheduler_.mode() == FrameScheduler::kOnDemand) {
+        if (!frame_scheduler_.takeRequest()) {
+            const double MAX_IDLE_WAIT = 0.1; // seconds
+            glfwWaitEventsTimeout(MAX_IDLE_WAIT);
+            pollGamepads();
+            draw = frame_scheduler_.takeRequest();
+        }
+    } else {
+        frame_scheduler_.waitUntilDue();
+    }
+    if (draw && render_thread_.joinable()) {
+        // a frame only goes in once there is room, and events are polled
+        // after a short wait whether or not there was
+        const double MAX_QUEUE_WAIT = 0.001; // seconds
+        if (render_queue_->waitForRoom(MAX_QUEUE_WAIT)) {
+            if (view_ != nullptr && controller_ != nullptr) {
+                controller_->windowControlViewWillRender(shared_from_this());
+            }
+            render_queue_->push([this] { renderFrame(); });
+            frame_scheduler_.frameFinished();
+        } else {
+            // still owed on demand
+            frame_scheduler_.requestFrame();
+        }
+    } else if (draw) {
+        if (view_ != nullptr && controller_ != nullptr) {
             controller_->windowControlViewWillRender(shared_from_this());
         }
+        renderFrame();
+        frame_scheduler_.frameFinished();
+    }
+    glfwPollEvents();
+    pollGamepads();
+    if (glfwWindowShouldClose(glfw_handle_) && isVisible()) {
+        onClose(glfw_handle_);
+    }
+}
+
+void Window::
+renderFrame()
+{
+    const int swap_interval = frame_scheduler_.swapInterval();
+    if (swap_interval != swap_interval_) {
+        glfwSwapInterval(swap_interval);
+        swap_interval_ = swap_interval;
+    }
+    pollUploads();
+    if (view_ != nullptr) {
         view_->windowViewRender(shared_from_this());
     } else {
         glClearColor(0.25f, 0.f, 0.f, 0.f);
         glClear(GL_COLOR_BUFFER_BIT);
     }
     glfwSwapBuffers(glfw_handle_);
-    glfwPollEvents();
-    pollGamepads();
+}
+
+void Window::
+renderLoop()
+{
+    glfwMakeContextCurrent(glfw_handle_);
+    // an empty command asks the thread to stop
+    for (;;) {
+        CommandQueue::Command command = render_queue_->pop();
+        if (command == nullptr) {
+            break;
+        }
+        // an exception must not leave the thread, update() throws it on
+        try {
+            command();
+        } catch (...) {
+            keepThreadError(std::current_exception());
+        }
+    }
+    glfwMakeContextCurrent(NULL);
+}
+
+void Window::
+keepThreadError(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(thread_error_mutex_);
+    if (thread_error_ == nullptr) {
+        thread_error_ = error;
+    }
+}
+
+void Window::
+rethrowThreadError()
+{
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(thread_error_mutex_);
+        std::swap(error, thread_error_);
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Window::
+stopRenderThread()
+{
+    if (!render_thread_.joinable()) {
+        return;
+    }
+    render_queue_->push(CommandQueue::Command());
+    render_thread_.join();
+    render_queue_.reset();
+    glfwMakeContextCurrent(glfw_handle_);
 }
 
 void Window::
 close()
 {
+    stopRenderThread();
+    stopUploadThread();
     glfwDestroyWindow(glfw_handle_);
     glfwTerminate();
     if (main_window_.get() == this) {
@@ -199,6 +519,12 @@ close()
     }
 }
 
+void Window::
+requestClose()
+{
+    glfwSetWindowShouldClose(glfw_handle_, GL_TRUE);
+}
+
 void Window::
 setTitle(std::string newTitle)
 {
@@ -244,9 +570,14 @@ onResize(GLFWwindow* handle,
          int height)
 {
     Window* window = main_window_.get();
-    if (window != nullptr && window->view_ != nullptr) {
-        window->view_->windowViewDidReset(window->shared_from_this(),
-                                          width, height);
+    if (window != nullptr) {
+        window->frame_scheduler_.requestFrame();
+        auto self = window->shared_from_this();
+        window->runOnRenderThread([window, self, width, height] {
+            if (window->view_ != nullptr) {
+                window->view_->windowViewDidReset(self, width, height);
+            }
+        });
     }
 }
 
@@ -259,9 +590,13 @@ onClose(GLFWwindow* handle)
             window->controller_
               ->windowControlDidStop(window->shared_from_this());
         }
-        if (window->view_ != nullptr) {
-            window->view_->windowViewDidStop(window->shared_from_this());
-        }
+        auto self = window->shared_from_this();
+        window->runOnRenderThread([window, self] {
+            if (window->view_ != nullptr) {
+                window->finishUploads();
+                window->view_->windowViewDidStop(self);
+            }
+        }, true);
         glfwHideWindow(window->glfw_handle_);
     }
 }
@@ -272,6 +607,9 @@ onMouseMove(GLFWwindow* handle,
             double y)
 {
     Window* window = main_window_.get();
+    if (window != nullptr) {
+        window->frame_scheduler_.requestFrame();
+    }
     if (window != nullptr && window->controller_ != nullptr) {
         window->controller_->windowControlMouseMoved(window->shared_from_this(),
                                                      (int)x,
@@ -285,6 +623,9 @@ onMouseWheel(GLFWwindow* handle,
              double y)
 {
     Window* window = main_window_.get();
+    if (window != nullptr) {
+        window->frame_scheduler_.requestFrame();
+    }
     if (window != nullptr && window->controller_ != nullptr) {
         window->controller_
           ->windowControlMouseWheelMoved(window->shared_from_this(),
@@ -299,6 +640,9 @@ onMouseButton(GLFWwindow* handle,
               int mods)
 {
     Window* window = main_window_.get();
+    if (window != nullptr) {
+        window->frame_scheduler_.requestFrame();
+    }
     if (window != nullptr && window->controller_ != nullptr) {
         window->controller_
           ->windowControlMouseButtonChanged(window->shared_from_this(),
@@ -315,6 +659,9 @@ onKeyEvent(GLFWwindow* handle,
            int mods)
 {
     Window* window = main_window_.get();
+    if (window != nullptr) {
+        window->frame_scheduler_.requestFrame();
+    }
     if (window != nullptr && window->controller_ != nullptr) {
         window->controller_
           ->windowControlKeyboardChanged(window->shared_from_this(),
@@ -350,6 +697,7 @@ pollGamepads()
                 newState.button[j] = buttons[j];
             }
             if (newState.present != gamepad_state_[i].present) {
+                window->frame_scheduler_.requestFrame();
                 window->controller_->
                     windowControlGamepadPresenceChanged(window->shared_from_this(),
                     i,
@@ -363,6 +711,7 @@ pollGamepads()
             // TODO: dpad seems to be missing
             for (int j=0; j<num_axes; ++j) {
                 if (newState.axis[j] != gamepad_state_[i].axis[j]) {
+                    window->frame_scheduler_.requestFrame();
                     window->controller_->
                       windowControlGamepadAxisMoved(window->shared_from_this(),
                                                     i,
@@ -372,6 +721,7 @@ pollGamepads()
             }
             for (int j=0; j<num_buttons; ++j) {
                 if (newState.button[j] != gamepad_state_[i].button[j]) {
+                    window->frame_scheduler_.requestFrame();
                     window->controller_->windowControlGamepadButtonChanged(
                                             window->shared_from_this(),
                                             i,
@@ -385,14 +735,20 @@ pollGamepads()
 }
 
 Window::
-Window()
+Window() : use_render_thread_(false), swap_interval_(0),
+           use_upload_thread_(false)
 {
     glfw_handle_ = nullptr;
+    upload_handle_ = nullptr;
 }
 
 Window::
 ~Window()
 {
+    // close() is skipped when an exception leaves the runloop, the threads
+    // must still be joined before they are destroyed
+    stopRenderThread();
+    stopUploadThread();
 }
 
 Window::GamepadState::